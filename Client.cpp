@@ -108,7 +108,6 @@ void BMClient::process() {
 	std::lock_guard<std::mutex> lock(_workMutex);
 	if (_height != 0 && _blockInterval > 0. && timeSince(_timer) >= _blockInterval) {
 		_height++;
-		_requests = 0;
 		_timer = std::chrono::steady_clock::now();
 	}
 }
@@ -122,14 +121,13 @@ bool BMClient::getJob(Job& job, const bool dummy) {
 	job.height = _height;
 	job.difficulty = _difficulty;
 	const uint64_t difficultyAsInteger(std::round(65536.*job.difficulty));
-	// Target: (in binary) 1 . Leading Digits L (16 bits) . Height (32 bits) . Requests (32 bits) . (Difficulty - 80) zeros = 2^(Difficulty - 80)(2^80 + 2^64*L + 2^32*Height + Requests)
+	// Target: (in binary) 1 . Leading Digits L (16 bits) . Requests (64 bits) . (Difficulty - 80) zeros = 2^(Difficulty - 80)(2^80 + 2^64*L + Requests)
+	// The Requests are not reset at new blocks, so each target follows the previous one by 2^(Difficulty - 80) and the miner can update its presieve instead of doing it again
 	job.target = 1;
 	job.target <<= 16;
 	job.target += static_cast<uint16_t>(std::round(std::pow(2., 16. + static_cast<double>(difficultyAsInteger % 65536)/65536.)) - 65536.);
-	job.target <<= 32;
-	job.target += job.height;
-	job.target <<= 32;
-	job.target += _requests;
+	job.target <<= 64;
+	job.target += u64ToMpz(_requests);
 	job.target <<= (difficultyAsInteger/65536ULL - 80ULL);
 	job.primeCountTarget = _pattern.size();
 	job.primeCountMin = job.primeCountTarget;
@@ -138,19 +136,24 @@ bool BMClient::getJob(Job& job, const bool dummy) {
 }
 
 bool SearchClient::getJob(Job& job, const bool) {
+	std::lock_guard<std::mutex> lock(_workMutex);
 	job.height = 1;
 	job.difficulty = _difficulty;
-	// Target: (in binary) 1 . Leading Digits L (16 bits) . 80 Random Bits . (Difficulty - 96) zeros = 2^(Difficulty - 96)*(2^96 + 2^80*L + Random)
+	// Target: (in binary) 1 . Leading Digits L (16 bits) . 80 Random Bits + Requests . (Difficulty - 96) zeros = 2^(Difficulty - 96)*(2^96 + 2^80*L + Random + Requests)
+	// The random bits are drawn once, then each target follows the previous one by 2^(Difficulty - 96) so the miner can update its presieve instead of doing it again
 	const uint64_t difficultyAsInteger(std::round(65536.*job.difficulty));
-	std::array<uint8_t, 10> random;
-	for (auto &byte : random) byte = rand(0x00, 0xFF);
-	job.target = 1;
-	job.target <<= 16;
-	job.target += static_cast<uint16_t>(std::round(std::pow(2., 16. + static_cast<double>(difficultyAsInteger % 65536)/65536.)) - 65536.);
-	for (uint8_t i(0) ; i < 5 ; i++) {
-		job.target <<= 16;
-		job.target += reinterpret_cast<uint16_t*>(random.data())[4 - i];
+	if (_random == 0) {
+		std::array<uint8_t, 10> random;
+		for (auto &byte : random) byte = rand(0x00, 0xFF);
+		_random = 1; // Guarantees 96 bits for the part below
+		_random <<= 16;
+		_random += static_cast<uint16_t>(std::round(std::pow(2., 16. + static_cast<double>(difficultyAsInteger % 65536)/65536.)) - 65536.);
+		for (uint8_t i(0) ; i < 5 ; i++) {
+			_random <<= 16;
+			_random += reinterpret_cast<uint16_t*>(random.data())[4 - i];
+		}
 	}
+	job.target = _random + u64ToMpz(_requests++);
 	job.target <<= (job.difficulty - 96);
 	job.primeCountTarget = _pattern.size();
 	job.primeCountMin = job.primeCountTarget;
@@ -96,7 +96,8 @@ class BMClient : public Client {
 	const std::vector<uint64_t> _pattern;
 	const double _difficulty, _blockInterval;
 	// Client State Variables
-	uint32_t _height, _requests;
+	uint32_t _height;
+	uint64_t _requests;
 	std::chrono::time_point<std::chrono::steady_clock> _timer;
 public:
 	BMClient(const Options &options) : _pattern(options.minerParameters().pattern), _difficulty(options.difficulty()), _blockInterval(options.benchmarkBlockInterval()), _height(0), _requests(0) {} // The timer is initialized at the first getJob call.
@@ -114,8 +115,10 @@ class SearchClient : public Client {
 	const std::string _tuplesFilename;
 	// Client State Variables
 	std::mutex _tupleFileMutex;
+	mpz_class _random; // 1 . Leading Digits . Random Bits, 0 before the first job
+	uint64_t _requests;
 public:
-	SearchClient(const Options &options) : _pattern(options.minerParameters().pattern), _difficulty(options.difficulty()), _tuplesFilename(options.tuplesFile()) {
+	SearchClient(const Options &options) : _pattern(options.minerParameters().pattern), _difficulty(options.difficulty()), _tuplesFilename(options.tuplesFile()), _random(0), _requests(0) {
 		std::cout << "Tuples will be written to file " << _tuplesFilename << std::endl;
 	}
 	bool getJob(Job&, const bool = false); // Work is generated here
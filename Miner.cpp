@@ -1,6 +1,9 @@
 /* (c) 2017-2021 Pttn (https://github.com/Pttn/rieMiner)
 (c) 2018-2020 Michael Bell/Rockhawk (assembly optimizations, improvements of work management between threads, and some more) (https://github.com/MichaelBell/) */
 
+#ifndef _WIN32
+	#include <signal.h>
+#endif
 #include <gmpxx.h> // With Uint64_Ts, we still need to use the Mpz_ functions, otherwise there are "ambiguous overload" errors on Windows...
 
 #include "external/gmp_util.h"
@@ -15,11 +18,253 @@ extern "C" {
 }
 
 constexpr uint64_t nPrimesTo2p32(203280221);
+constexpr uint64_t nPrimesTo2p37(5586502348);
+constexpr uint64_t remainderTreeMinLimbs(16); // Candidate size (1024 bits) from which the presieve remainder tree is tried, and then used if it was measured faster
+constexpr uint64_t ifmaPrimeMax(1ULL << 50); // The AVX-512 IFMA code computing the first eliminated factors works for the primes below this
+constexpr uint64_t progressiveStartupPrimeTableLimit(16777216); // The initial table is small enough to be ready in a fraction of a second
+constexpr uint64_t primeTableLimitMax(2147483648ULL); // For the automatic Prime Table Limit
 constexpr int factorsCacheSize(16384);
+constexpr uint64_t sieveBlockSize(1 << 20); // Bits of the factorsTable sieved at once for the small primes, so the block (128 kB) stays in the L2 cache
+constexpr uint64_t presieveSliceSize(65536); // Number of primes claimed at once by a Presieve Task, the unclaimed ones can be stolen
 constexpr uint16_t maxSieveWorkers(64); // There is a noticeable performance penalty using Std Vector or Arrays so we are using Raw Arrays.
 thread_local uint64_t** factorsCache{nullptr};
-thread_local uint64_t** factorsCacheCounts{nullptr};
+thread_local uint32_t* factorsBucketsEnds{nullptr}; // To sort the factors cache by bucket before adding its factors to the shared chunks
+thread_local uint16_t* factorsSorted{nullptr};
+thread_local int factorsCacheSieveWorkers(0); // Dimensions of the factors caches, kept by the pooled threads between runs
+thread_local uint64_t factorsCacheBuckets(0);
 thread_local uint16_t threadId(65535);
+thread_local RemainderTree presieveRemainderTree; // Kept by the threads so the numbers of the tree and the primes of its chunk are not reallocated for every presieve range
+thread_local std::vector<uint64_t> presieveChunkPrimes;
+
+#pragma GCC diagnostic push // GCC 12 wrongly warns about the AVX-512 intrinsics using undefined vectors
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+// AVX-512 alternative to the rie_mod_1s_2p assembly functions, for 16 primes < 2^32 with the same bit length. Uses 64 bits lanes, with 32 bits limbs in the divisions.
+// The candidate is reduced modulo each p using 2^32, 2^64 and 2^96 mod p, a carry being replaced by 2^64 mod p, then the result is computed like in rie_mod_1s_2p: ((p - a % p)*inverse) % p.
+__attribute__((target("avx512f"))) static inline __m512i udivRnndPreinv32(const __m512i nh, const __m512i nl, const __m512i d, const __m512i di) { // (nh*2^32 + nl) % d, with d normalized, di its inverse and nh < d
+	const __m512i mask32(_mm512_set1_epi64(0xFFFFFFFFULL));
+	const __m512i q(_mm512_add_epi64(_mm512_mul_epu32(di, nh), _mm512_or_si512(_mm512_slli_epi64(_mm512_add_epi64(nh, _mm512_set1_epi64(1)), 32), nl)));
+	__m512i r(_mm512_and_si512(_mm512_sub_epi64(nl, _mm512_mul_epu32(_mm512_srli_epi64(q, 32), d)), mask32));
+	r = _mm512_and_si512(_mm512_mask_add_epi64(r, _mm512_cmpgt_epu64_mask(r, _mm512_and_si512(q, mask32)), r, d), mask32);
+	return _mm512_mask_sub_epi64(r, _mm512_cmpge_epu64_mask(r, d), r, d);
+}
+__attribute__((target("avx512f"))) static inline __m512i mod64(const __m512i a, const __m512i d, const __m512i di, const __m128i cnt, const __m128i cntComplement) { // a % p for any 64 bits a, with d = p << cnt
+	const __m512i as(_mm512_sll_epi64(a, cnt));
+	const __m512i r(udivRnndPreinv32(_mm512_srl_epi64(a, cntComplement), _mm512_srli_epi64(as, 32), d, di));
+	return _mm512_srl_epi64(udivRnndPreinv32(r, _mm512_and_si512(as, _mm512_set1_epi64(0xFFFFFFFFULL)), d, di), cnt);
+}
+__attribute__((target("avx512f"))) static void mod16TimesAvx512(const uint64_t *a, const uint64_t n, const uint32_t *ps, const uint32_t cnt, const uint64_t *cps, uint64_t *inverses) { // Same arguments as rie_mod_1s_2p_8times
+	const __m128i cnt128(_mm_cvtsi32_si128(cnt)), cntComplement128(_mm_cvtsi32_si128(64 - cnt));
+	__m512i d[2], di[2], b1[2], b2[2], b3[2], acc[2];
+	for (int h(0) ; h < 2 ; h++) {
+		d[h] = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&ps[8*h])));
+		di[h] = _mm512_srli_epi64(_mm512_loadu_si512(&cps[8*h]), 32); // The 32 bits inverse of d is the high part of the 64 bits one of d << 32
+		// Shifted by cnt, 2^32, 2^64 and 2^96 mod p
+		b1[h] = udivRnndPreinv32(_mm512_set1_epi64(1ULL << cnt), _mm512_setzero_si512(), d[h], di[h]);
+		b2[h] = udivRnndPreinv32(b1[h], _mm512_setzero_si512(), d[h], di[h]);
+		b3[h] = udivRnndPreinv32(b2[h], _mm512_setzero_si512(), d[h], di[h]);
+		b1[h] = _mm512_srl_epi64(b1[h], cnt128);
+		b2[h] = _mm512_srl_epi64(b2[h], cnt128);
+		b3[h] = _mm512_srl_epi64(b3[h], cnt128);
+		acc[h] = _mm512_set1_epi64(a[n - 1]);
+	}
+	for (uint64_t k(n - 1) ; k-- > 0 ;) { // acc = acc*2^64 + a[k] mod p, without overflowing
+		const __m512i limbHigh(_mm512_set1_epi64(a[k] >> 32)), limbLow(_mm512_set1_epi64(a[k] & 0xFFFFFFFFULL));
+		for (int h(0) ; h < 2 ; h++) {
+			const __m512i t(_mm512_add_epi64(_mm512_mul_epu32(limbHigh, b1[h]), limbLow));
+			__m512i u(_mm512_add_epi64(_mm512_mul_epu32(acc[h], b2[h]), t));
+			u = _mm512_mask_add_epi64(u, _mm512_cmplt_epu64_mask(u, t), u, b2[h]);
+			acc[h] = _mm512_add_epi64(_mm512_mul_epu32(_mm512_srli_epi64(acc[h], 32), b3[h]), u);
+			acc[h] = _mm512_mask_add_epi64(acc[h], _mm512_cmplt_epu64_mask(acc[h], u), acc[h], b2[h]);
+		}
+	}
+	for (int h(0) ; h < 2 ; h++) {
+		const __m512i p(_mm512_srl_epi64(d[h], cnt128));
+		const __m512i pa(_mm512_sub_epi64(p, mod64(acc[h], d[h], di[h], cnt128, cntComplement128))); // p if the remainder is 0, giving 0 anyway
+		_mm512_storeu_si512(&inverses[8*h], mod64(_mm512_mul_epu32(pa, _mm512_loadu_si512(&inverses[8*h])), d[h], di[h], cnt128, cntComplement128));
+	}
+}
+// AVX-512 IFMA computation of the first eliminated factors for 32 primes between 2^32 and 2^50, using Montgomery arithmetic with R = 2^52.
+// The candidate, given as 52 bits digits, is reduced from its least significant digit, giving a*R^-n mod p, then multiplied by R^(n + 2) (obtained by exponentiation from R^2 mod p, computed using doubles) to get back a*R mod p.
+// The constants (-1/p mod R, R^2 mod p) are derived in registers for each group, so unlike the division data of the primes < 2^37, nothing has to be stored per prime.
+__attribute__((target("avx512f,avx512dq,avx512ifma"))) static inline __m512i montgomeryMultiply(const __m512i a, const __m512i b, const __m512i p, const __m512i pInv) { // a*b/R mod p, with a <= p + 1, b < p and pInv = -1/p mod R
+	const __m512i zero(_mm512_setzero_si512());
+	const __m512i tLow(_mm512_madd52lo_epu64(zero, a, b)), tHigh(_mm512_madd52hi_epu64(zero, a, b));
+	const __m512i m(_mm512_madd52lo_epu64(zero, tLow, pInv));
+	__m512i t(_mm512_madd52hi_epu64(tHigh, m, p)); // tLow + lo(m*p) is 0 or R
+	t = _mm512_mask_add_epi64(t, _mm512_test_epi64_mask(tLow, tLow), t, _mm512_set1_epi64(1));
+	return _mm512_mask_sub_epi64(t, _mm512_cmpge_epu64_mask(t, p), t, p);
+}
+__attribute__((target("avx512f,avx512dq,avx512ifma"))) static inline __m512i montgomeryReduce(const __m512i x, const __m512i p, const __m512i pInv) { // x/R mod p in [0, p + 1], with x < 2^53
+	const __m512i mask52(_mm512_set1_epi64((1ULL << 52) - 1ULL));
+	const __m512i m(_mm512_madd52lo_epu64(_mm512_setzero_si512(), x, pInv));
+	const __m512i t(_mm512_madd52hi_epu64(_mm512_srli_epi64(x, 52), m, p));
+	return _mm512_mask_add_epi64(t, _mm512_test_epi64_mask(x, mask52), t, _mm512_set1_epi64(1));
+}
+// inverses: in, the inverses of the primorial, out, ((p - a % p)*inverse) % p. The primes must be sorted.
+// If nOffsets > 0, also computes offsetRemainders[8*nVectors*k + j] = (offsets[k]*inverse_j) % p for the offsets < 2^52 of the other Sieve Workers.
+template <int nVectors> __attribute__((target("avx512f,avx512dq,avx512ifma"))) static void modTimesAvx512Ifma(const uint64_t *digits, const uint64_t nDigits, const uint64_t *ps, uint64_t *inverses, const uint64_t *offsets, const int nOffsets, uint64_t *offsetRemainders) {
+	const __m512i mask52(_mm512_set1_epi64((1ULL << 52) - 1ULL));
+	__m512i p[nVectors], pInv[nVectors], s[nVectors];
+	for (int v(0) ; v < nVectors ; v++) {
+		p[v] = _mm512_loadu_si512(&ps[8*v]);
+		__m512i x(p[v]); // 1/p mod R with Newton's method, correct to 3 bits at the start for odd p
+		for (int j(0) ; j < 5 ; j++)
+			x = _mm512_madd52lo_epu64(_mm512_setzero_si512(), x, _mm512_sub_epi64(_mm512_set1_epi64(2), _mm512_madd52lo_epu64(_mm512_setzero_si512(), p[v], x)));
+		pInv[v] = _mm512_and_si512(_mm512_sub_epi64(_mm512_setzero_si512(), x), mask52);
+		s[v] = _mm512_setzero_si512();
+	}
+	for (uint64_t j(0) ; j < nDigits ; j++) { // s = (s + d)/R mod p, s staying in [0, p + 1]
+		const __m512i d(_mm512_set1_epi64(digits[j]));
+		for (int v(0) ; v < nVectors ; v++)
+			s[v] = montgomeryReduce(_mm512_add_epi64(s[v], d), p[v], pInv[v]);
+	}
+	const int maxShift(53 - (64 - __builtin_clzll(ps[8*nVectors - 1]))); // Largest shift keeping r*2^shift < 2^53 for the largest prime
+	for (int v(0) ; v < nVectors ; v++) {
+		// R^2 mod p, from 2^32 < p, multiplying by 2^maxShift or less at once so the products are exact doubles
+		const __m512d pd(_mm512_cvtepu64_pd(p[v])), pdInv(_mm512_div_pd(_mm512_set1_pd(1.), pd));
+		__m512i r(_mm512_set1_epi64(1ULL << 32));
+		for (int remainingBits(72) ; remainingBits > 0 ; remainingBits -= maxShift) {
+			const __m512i y(_mm512_sll_epi64(r, _mm_cvtsi32_si128(std::min(maxShift, remainingBits))));
+			const __m512i q(_mm512_cvttpd_epi64(_mm512_mul_pd(_mm512_cvtepu64_pd(y), pdInv))); // Off by 1 at most
+			r = _mm512_sub_epi64(y, _mm512_mullo_epi64(q, p[v]));
+			r = _mm512_mask_add_epi64(r, _mm512_cmplt_epi64_mask(r, _mm512_setzero_si512()), r, p[v]);
+			r = _mm512_mask_sub_epi64(r, _mm512_cmpge_epi64_mask(r, p[v]), r, p[v]);
+		}
+		// With w_k = R^(k + 1), montgomeryMultiply(w_a, w_b) = w_(a + b), get w_(n + 1) = R^(n + 2) from w_1 = R^2
+		__m512i w(r);
+		const uint64_t e(nDigits + 1);
+		for (int b(62 - __builtin_clzll(e)) ; b >= 0 ; b--) {
+			w = montgomeryMultiply(w, w, p[v], pInv[v]);
+			if ((e >> b) & 1) w = montgomeryMultiply(w, r, p[v], pInv[v]);
+		}
+		const __m512i inverse(_mm512_loadu_si512(&inverses[8*v]));
+		const __m512i aR(montgomeryMultiply(s[v], w, p[v], pInv[v])); // a*R mod p
+		const __m512i u(montgomeryMultiply(aR, inverse, p[v], pInv[v])); // a*inverse mod p
+		_mm512_storeu_si512(&inverses[8*v], _mm512_maskz_sub_epi64(_mm512_test_epi64_mask(u, u), p[v], u));
+		if (nOffsets > 0) { // offset*inverse mod p = montgomeryMultiply(offset/R, inverse*R^2)
+			const __m512i inverseR2(montgomeryMultiply(inverse, montgomeryMultiply(r, r, p[v], pInv[v]), p[v], pInv[v]));
+			for (int k(0) ; k < nOffsets ; k++)
+				_mm512_storeu_si512(&offsetRemainders[8*nVectors*k + 8*v], montgomeryMultiply(montgomeryReduce(_mm512_set1_epi64(offsets[k]), p[v], pInv[v]), inverseR2, p[v], pInv[v]));
+		}
+	}
+}
+// Branch free SIMD replacement of the addFactorsToEliminateForP and recomputeFp macros of the presieve, for 16 primes < 2^32 (32 bits lanes) or 8 primes (64 bits lanes).
+// For each Sieve Worker, the factors of the tuple elements are fp, fp - mi[halfPattern[1]], ... (mod p), and the fp of the next Sieve Worker is the last one minus its offset remainder.
+template <typename T> __attribute__((target("avx512f"))) static inline __m512i modSubAvx512(const __m512i a, const __m512i b, const __m512i p) { // a - b mod p, for a < p and b <= p
+	if constexpr (sizeof(T) == 4) return _mm512_mask_add_epi32(_mm512_sub_epi32(a, b), _mm512_cmplt_epu32_mask(a, b), _mm512_sub_epi32(a, b), p);
+	else return _mm512_mask_add_epi64(_mm512_sub_epi64(a, b), _mm512_cmplt_epu64_mask(a, b), _mm512_sub_epi64(a, b), p);
+}
+template <typename T> __attribute__((target("avx512f"))) static inline __m512i loadAvx512(const __mmask16 mask, const T *a) {
+	if constexpr (sizeof(T) == 4) return _mm512_maskz_loadu_epi32(mask, a);
+	else return _mm512_maskz_loadu_epi64(static_cast<__mmask8>(mask), a);
+}
+template <int tupleSize, typename T> __attribute__((target("avx512f"))) static inline void factorsAvx512(const __m512i fp, const __m512i p, const __m512i (&mi)[4], const uint64_t *halfPattern, __m512i (&factors)[tupleSize]) {
+	factors[0] = fp;
+	for (int f(1) ; f < tupleSize ; f++)
+		factors[f] = modSubAvx512<T>(factors[f - 1], mi[halfPattern[f]], p);
+}
+template <typename T> __attribute__((target("avx512f"))) static inline void modularInversesMultiplesAvx512(const __m512i mi0, const __m512i p, __m512i (&mi)[4]) { // mi[i] = 2*i*mi[0] % p, a + b computed as a - (p - b)
+	mi[0] = mi0;
+	if constexpr (sizeof(T) == 4) {
+		mi[1] = modSubAvx512<T>(mi0, _mm512_sub_epi32(p, mi0), p);
+		mi[2] = modSubAvx512<T>(mi[1], _mm512_sub_epi32(p, mi[1]), p);
+		mi[3] = modSubAvx512<T>(mi[1], _mm512_sub_epi32(p, mi[2]), p);
+	}
+	else {
+		mi[1] = modSubAvx512<T>(mi0, _mm512_sub_epi64(p, mi0), p);
+		mi[2] = modSubAvx512<T>(mi[1], _mm512_sub_epi64(p, mi[1]), p);
+		mi[3] = modSubAvx512<T>(mi[1], _mm512_sub_epi64(p, mi[2]), p);
+	}
+}
+// Offset remainders offsetDiffs[k]*modularInverse mod p of the other Sieve Workers for up to 16 primes < 2^32, stored as offsetRemainders[16*k + j], without division.
+// The modular inverse times 2^32 and 2^64 mod p are obtained with double precision quotients, then each remainder is the sum of the Montgomery reductions of the low and high 32 bits of the offset times these.
+__attribute__((target("avx512f"))) static inline __m512i shift32Mod(const __m512i a, const __m512i p, const __m512d pd) { // a*2^32 mod p for a < p < 2^32 in 64 bits lanes, the estimated quotient being off by at most 1
+	const __m512i q(_mm512_cvtepu32_epi64(_mm512_cvttpd_epu32(_mm512_div_pd(_mm512_mul_pd(_mm512_cvtepu32_pd(_mm512_cvtepi64_epi32(a)), _mm512_set1_pd(4294967296.)), pd))));
+	__m512i r(_mm512_sub_epi64(_mm512_slli_epi64(a, 32), _mm512_mul_epu32(q, p)));
+	r = _mm512_mask_add_epi64(r, _mm512_cmplt_epi64_mask(r, _mm512_setzero_si512()), r, p);
+	return _mm512_mask_sub_epi64(r, _mm512_cmpge_epi64_mask(r, p), r, p);
+}
+__attribute__((target("avx512f"))) static inline __m512i montgomeryReduce32(const __m512i x, const __m512i p, const __m512i pInv) { // x/2^32 mod p for x < p*2^32, with pInv = -1/p mod 2^32
+	const __m512i mp(_mm512_mul_epu32(_mm512_mul_epu32(x, pInv), p)); // x + mp ≡ 0 (mod 2^32), so its high part is carried from the low one if x's is not 0
+	__m512i t(_mm512_add_epi64(_mm512_srli_epi64(x, 32), _mm512_srli_epi64(mp, 32)));
+	t = _mm512_mask_add_epi64(t, _mm512_test_epi64_mask(x, _mm512_set1_epi64(0xFFFFFFFFULL)), t, _mm512_set1_epi64(1));
+	return _mm512_mask_sub_epi64(t, _mm512_cmpge_epu64_mask(t, p), t, p);
+}
+__attribute__((target("avx512f"))) static inline __m256i half256(const __m512i a, const int h) {
+	return h == 0 ? _mm512_castsi512_si256(a) : _mm512_extracti64x4_epi64(a, 1);
+}
+__attribute__((target("avx512f"))) static void offsetRemaindersAvx512(const uint32_t *ps, const uint32_t *modularInverses, const uint64_t *offsetDiffs, const int nOffsets, const uint64_t n, uint32_t *offsetRemainders) {
+	const __mmask16 mask((1U << n) - 1U);
+	const __m512i p32(_mm512_mask_loadu_epi32(_mm512_set1_epi32(1), mask, ps)), mi32(_mm512_maskz_loadu_epi32(mask, modularInverses));
+	__m512i pInv32(p32); // Newton's iterations from p, which is its own inverse mod 8
+	for (int k(0) ; k < 4 ; k++)
+		pInv32 = _mm512_mullo_epi32(pInv32, _mm512_sub_epi32(_mm512_set1_epi32(2), _mm512_mullo_epi32(p32, pInv32)));
+	pInv32 = _mm512_sub_epi32(_mm512_setzero_si512(), pInv32);
+	for (int h(0) ; h < 2 ; h++) {
+		const __m512i p(_mm512_cvtepu32_epi64(half256(p32, h))), pInv(_mm512_cvtepu32_epi64(half256(pInv32, h)));
+		const __m512d pd(_mm512_cvtepu32_pd(half256(p32, h)));
+		const __m512i mi1(shift32Mod(_mm512_cvtepu32_epi64(half256(mi32, h)), p, pd)), mi2(shift32Mod(mi1, p, pd));
+		for (int k(0) ; k < nOffsets ; k++) {
+			__m512i r(_mm512_add_epi64(montgomeryReduce32(_mm512_mul_epu32(_mm512_set1_epi64(offsetDiffs[k] & 0xFFFFFFFFULL), mi1), p, pInv),
+			                           montgomeryReduce32(_mm512_mul_epu32(_mm512_set1_epi64(offsetDiffs[k] >> 32), mi2), p, pInv)));
+			r = _mm512_mask_sub_epi64(r, _mm512_cmpge_epu64_mask(r, p), r, p);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(&offsetRemainders[16*k + 8*h]), _mm512_cvtepi64_epi32(r));
+		}
+	}
+}
+// For the primes below the threshold, the factors are scattered to the factorsToEliminate of every Sieve Worker (already offset to the first prime). n <= 16 primes, the offset remainders being stored as offsetRemainders[16*(sieveWorkerIndex - 1) + j], and the factors of consecutive primes being factorsStride entries apart.
+template <int tupleSize> __attribute__((target("avx512f"))) static void factorsToEliminateAvx512(const uint32_t *ps, const uint32_t *modularInverses, const uint32_t *fps, const uint32_t *offsetRemainders, const int nSieveWorkers, const uint64_t n, const uint64_t *halfPattern, const uint64_t factorsStride, uint32_t* const *factorsToEliminate) {
+	const __mmask16 mask((1U << n) - 1U);
+	const __m512i p(loadAvx512(mask, ps)), indexes(_mm512_mullo_epi32(_mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), _mm512_set1_epi32(factorsStride)));
+	__m512i mi[4], factors[tupleSize];
+	modularInversesMultiplesAvx512<uint32_t>(loadAvx512(mask, modularInverses), p, mi);
+	for (int j(0) ; j < nSieveWorkers ; j++) {
+		factorsAvx512<tupleSize, uint32_t>(j == 0 ? loadAvx512(mask, fps) : modSubAvx512<uint32_t>(factors[tupleSize - 1], loadAvx512(mask, &offsetRemainders[16*(j - 1)]), p), p, mi, halfPattern, factors);
+		for (int f(0) ; f < tupleSize ; f++)
+			_mm512_mask_i32scatter_epi32(&factorsToEliminate[j][f], mask, indexes, factors[f], 4);
+	}
+}
+// For the primes above, only the factors < factorMax are added to the factors caches, which must have room for tupleSize*n more entries.
+template <int tupleSize, typename T> __attribute__((target("avx512f"))) static void additionalFactorsToEliminateAvx512(const T *ps, const T *modularInverses, const T *fps, const T *offsetRemainders, const int nSieveWorkers, const uint64_t n, const uint64_t *halfPattern, const uint64_t factorMax, uint64_t* const *factorsCache, int *factorsCacheTotalCounts) {
+	constexpr uint64_t lanes(64/sizeof(T));
+	for (uint64_t h(0) ; h < n ; h += lanes) {
+		const __mmask16 mask(n - h >= lanes ? (1U << lanes) - 1U : (1U << (n - h)) - 1U);
+		const __m512i p(loadAvx512(mask, &ps[h]));
+		__m512i mi[4], factors[tupleSize];
+		modularInversesMultiplesAvx512<T>(loadAvx512(mask, &modularInverses[h]), p, mi);
+		for (int j(0) ; j < nSieveWorkers ; j++) {
+			factorsAvx512<tupleSize, T>(j == 0 ? loadAvx512(mask, &fps[h]) : modSubAvx512<T>(factors[tupleSize - 1], loadAvx512(mask, &offsetRemainders[16*(j - 1) + h]), p), p, mi, halfPattern, factors);
+			for (int f(0) ; f < tupleSize ; f++) {
+				T eliminated[lanes];
+				__mmask16 eliminatedMask;
+				if constexpr (sizeof(T) == 4) {
+					eliminatedMask = _mm512_mask_cmplt_epu32_mask(mask, factors[f], _mm512_set1_epi32(factorMax));
+					_mm512_mask_compressstoreu_epi32(eliminated, eliminatedMask, factors[f]);
+				}
+				else {
+					eliminatedMask = _mm512_mask_cmplt_epu64_mask(static_cast<__mmask8>(mask), factors[f], _mm512_set1_epi64(factorMax));
+					_mm512_mask_compressstoreu_epi64(eliminated, static_cast<__mmask8>(eliminatedMask), factors[f]);
+				}
+				for (int k(0), nEliminated(__builtin_popcount(eliminatedMask)) ; k < nEliminated ; k++)
+					factorsCache[j][factorsCacheTotalCounts[j]++] = eliminated[k];
+			}
+		}
+	}
+}
+#pragma GCC diagnostic pop
+
+static std::vector<uint64_t> digits52(const mpz_class &n) { // For modTimesAvx512Ifma, from the least significant
+	const uint64_t *limbs(reinterpret_cast<const uint64_t*>(n.get_mpz_t()->_mp_d)), nLimbs(n.get_mpz_t()->_mp_size);
+	std::vector<uint64_t> digits((mpz_sizeinbase(n.get_mpz_t(), 2) + 51)/52);
+	for (uint64_t j(0) ; j < digits.size() ; j++) {
+		const uint64_t limb(52*j/64), offset(52*j % 64);
+		uint64_t digit(limbs[limb] >> offset);
+		if (offset > 12 && limb + 1 < nLimbs) digit |= limbs[limb + 1] << (64 - offset);
+		digits[j] = digit & ((1ULL << 52) - 1ULL);
+	}
+	return digits;
+}
 
 void Miner::init(const MinerParameters &minerParameters) {
 	_shouldRestart = false;
@@ -77,7 +322,11 @@ void Miner::init(const MinerParameters &minerParameters) {
 	_parameters.sieveWorkers = std::min(static_cast<int>(_parameters.sieveWorkers), static_cast<int>(_primorialOffsets.size()));
 	std::cout << " (" << _parameters.sieveWorkers << " Sieve Worker(s))" << std::endl;
 	std::cout << "Best SIMD instructions supported:";
-	if (_cpuInfo.hasAVX512()) std::cout << " AVX-512";
+	if (_cpuInfo.hasAVX512()) {
+		std::cout << " AVX-512";
+		if (_cpuInfo.hasAVX512IFMA()) std::cout << " with IFMA";
+		if (!_parameters.useAvx512) std::cout << " (disabled for the presieve)";
+	}
 	else if (_cpuInfo.hasAVX2()) {
 		std::cout << " AVX2";
 		if (!_parameters.useAvx2) std::cout << " (disabled -> AVX)";
@@ -96,7 +345,6 @@ void Miner::init(const MinerParameters &minerParameters) {
 	}
 	
 	if (_parameters.primeTableLimit == 0) {
-		constexpr uint64_t primeTableLimitMax(2147483648ULL);
 		_parameters.primeTableLimit = std::pow(_difficultyAtInit, 6.)/std::pow(2., 3.*static_cast<double>(_parameters.pattern.size()) + 7.);
 		if (_parameters.threads > 16) {
 			_parameters.primeTableLimit *= 16;
@@ -107,75 +355,23 @@ void Miner::init(const MinerParameters &minerParameters) {
 	std::cout << "Prime Table Limit: " << _parameters.primeTableLimit << std::endl;
 	std::transform(_parameters.pattern.begin(), _parameters.pattern.end(), std::back_inserter(_halfPattern), [](uint64_t n) {return n >> 1;});
 	
-	std::vector<uint64_t> primes;
-	uint64_t primeTableFileBytes, savedPrimes(0), largestSavedPrime;
-	std::fstream file(primeTableFile);
-	if (file) {
-		file.seekg(0, std::ios::end);
-		primeTableFileBytes = file.tellg();
-		savedPrimes = primeTableFileBytes/sizeof(decltype(primes)::value_type);
-		if (savedPrimes > 0) {
-			file.seekg(-static_cast<int64_t>(sizeof(decltype(primes)::value_type)), std::ios::end);
-			file.read(reinterpret_cast<char*>(&largestSavedPrime), sizeof(decltype(primes)::value_type));
-		}
-	}
-	std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
-	if (savedPrimes > 0 && _parameters.primeTableLimit >= 1048576 && _parameters.primeTableLimit <= largestSavedPrime) {
-		std::cout << "Extracting prime numbers from " << primeTableFile << " (" << primeTableFileBytes << " bytes, " << savedPrimes << " primes, largest " << largestSavedPrime << ")..." << std::endl;
-		uint64_t nPrimesUpperBound(std::min(1.085*static_cast<double>(_parameters.primeTableLimit)/std::log(static_cast<double>(_parameters.primeTableLimit)), static_cast<double>(savedPrimes))); // 1.085 = max(π(p)log(p)/p) for p >= 2^20
-		try {
-			primes = std::vector<uint64_t>(nPrimesUpperBound);
-		}
-		catch (std::bad_alloc& ba) {
-			ERRORMSG("Unable to allocate memory for the prime table");
-			_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/8, _parameters.sieveWorkers);
-			return;
-		}
-		file.seekg(0, std::ios::beg);
-		file.read(reinterpret_cast<char*>(primes.data()), nPrimesUpperBound*sizeof(decltype(primes)::value_type));
-		file.close();
-		for (auto i(primes.size() - 1) ; i > 0 ; i--) {
-			if (primes[i] <= _parameters.primeTableLimit) {
-				primes.resize(i + 1);
-				break;
-			}
-		}
-		std::cout << primes.size() << " first primes extracted in " << timeSince(t0) << " s (" << primes.size()*sizeof(decltype(primes)::value_type) << " bytes)." << std::endl;
-	}
-	else {
-		std::cout << "Generating prime table using sieve of Eratosthenes..." << std::endl;
-		try {
-			primes = generatePrimeTable(_parameters.primeTableLimit);
-		}
-		catch (std::bad_alloc& ba) {
-			ERRORMSG("Unable to allocate memory for the prime table");
-			_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/8, _parameters.sieveWorkers);
-			return;
-		}
-		std::cout << "Table with all " << primes.size() << " first primes generated in " << timeSince(t0) << " s (" << primes.size()*sizeof(decltype(primes)::value_type) << " bytes)." << std::endl;
+	std::unique_ptr<RetainedData> retainedData(std::move(_retainedData)); // After a retune or preload, what is not reused is freed at the end of the initialization
+	const bool progressiveStartupAllowed(_parameters.progressiveStartup && _mode != "Benchmark" && _parameters.primeTableLimit > progressiveStartupPrimeTableLimit);
+	if (_preloadThread.joinable() && (_preloadedDataReady || !progressiveStartupAllowed)) { // Else, the preload continues and will be used by the progressive startup
+		if (!_preloadedDataReady) std::cout << "Waiting for the preload to finish..." << std::endl;
+		_preloadThread.join();
+		if (retainedData == nullptr) retainedData = std::move(_preloadedData);
+		_preloadedData.reset();
 	}
-
-	if (primes.size() % 2 == 1) // Needs to be even to use SIMD sieving optimizations
-		primes.pop_back();
-	
-	try {
-		_primes32.reserve(std::min(nPrimesTo2p32, primes.size()));
-		if (primes.size() > nPrimesTo2p32) _primes64.reserve(primes.size() - nPrimesTo2p32);
-	}
-	catch (std::bad_alloc& ba) {
-		ERRORMSG("Unable to allocate memory for the prime table");
-		_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/8, _parameters.sieveWorkers);
+	const bool reusePrimeTable(retainedData != nullptr && _reusePrimeTable(*retainedData, _primes32, _primes64));
+	const bool progressiveStartup(!reusePrimeTable && progressiveStartupAllowed);
+	if (progressiveStartup)
+		std::cout << "Progressive startup: mining will begin with the primes up to " << progressiveStartupPrimeTableLimit << " while the full table is prepared in the background" << std::endl;
+	if (!reusePrimeTable && !_loadPrimeTable(progressiveStartup ? progressiveStartupPrimeTableLimit : _parameters.primeTableLimit, _primes32, _primes64))
 		return;
-	}
-
-	for (size_t i = 0; i < primes.size(); ++i) {
-		if (primes[i] < (1ULL << 32)) _primes32.push_back(primes[i]);
-		else _primes64.push_back(primes[i]);
-	}
-
-	_nPrimes = primes.size();
+	_primeTableLimit = progressiveStartup ? progressiveStartupPrimeTableLimit : _parameters.primeTableLimit;
 	_nPrimes32 = _primes32.size();
-	primes.clear();
+	_nPrimes = _nPrimes32 + _primes64.size();
 
 	if (_parameters.sieveBits == 0)
 		_parameters.sieveBits = _parameters.sieveWorkers <= 4 ? 25 : 24;
@@ -185,6 +381,8 @@ void Miner::init(const MinerParameters &minerParameters) {
 	if (_parameters.sieveIterations == 0)
 		_parameters.sieveIterations = 16;
 	std::cout << "Sieve Iterations: " << _parameters.sieveIterations << std::endl;
+	_factorsBucketBits = std::min(_parameters.sieveBits, factorsBucketBits);
+	_factorsBuckets = _parameters.sieveIterations << (_parameters.sieveBits - _factorsBucketBits);
 	_factorMax = _parameters.sieveIterations*_parameters.sieveSize;
 	std::cout << "Primorial Factor Max: " << _factorMax << std::endl;
 	
@@ -227,115 +425,575 @@ void Miner::init(const MinerParameters &minerParameters) {
 	else
 		std::cout << "~" << _primorial.get_str()[0] << "." << _primorial.get_str().substr(1, 12) << "*10^" << _primorial.get_str().size() - 1;
 	std::cout << " (" << mpz_sizeinbase(_primorial.get_mpz_t(), 2) << " bits)" << std::endl;
+	_extendJobs = _parameters.extendJobs && _mode != "Pool";
+	if (_extendJobs) { // The primorial factors must also fit in the 64 bits of the encoded offset
+		mpz_class factorWindows(1);
+		factorWindows <<= bitsForOffset;
+		factorWindows /= _primorial*u64ToMpz(_factorMax);
+		const uint64_t factorWindowsMax(std::numeric_limits<uint64_t>::max()/_factorMax);
+		_factorWindows = factorWindows > u64ToMpz(factorWindowsMax) ? factorWindowsMax : std::max(mpzToU64(factorWindows), static_cast<uint64_t>(1));
+		std::cout << "Primorial Factor Windows per job: " << _factorWindows << std::endl;
+	}
+	else
+		_factorWindows = 1;
 	std::cout << "Primorial Offsets: " << _primorialOffsets.size() << std::endl;
 	_primorialOffsetDiff.resize(_parameters.sieveWorkers - 1);
 	const uint64_t constellationDiameter(cumulativeOffsets.back());
 	for (int j(1) ; j < _parameters.sieveWorkers ; j++)
 		_primorialOffsetDiff[j - 1] = _parameters.primorialOffsets[j] - _parameters.primorialOffsets[j - 1] - constellationDiameter;
 	
-	uint64_t additionalFactorsCountEstimation(0); // tupleSize*factorMax*(sum of 1/p, for p in the prime table >= factorMax); it is the estimation of how many such p will eliminate a factor (factorMax/p being the probability of the modulo p being < factorMax)
-	double sumInversesOfPrimes(0.);
-	_primesIndexThreshold = 0; // Number of prime numbers smaller than factorMax in the table
-	for (uint64_t i(0) ; i < _nPrimes ; i++) {
-		const uint64_t p(_getPrime(i));
-		if (p >= _factorMax) {
-			if (_primesIndexThreshold == 0) {
-				_primesIndexThreshold = i;
-				if (_primesIndexThreshold % 2 == 1) // Needs to be even to use SIMD sieving optimizations
-					_primesIndexThreshold--;
+	uint64_t additionalFactorsCountEstimation;
+	_computePrimesIndexThreshold(_primes32, _primes64, _primesIndexThreshold, additionalFactorsCountEstimation);
+	std::cout << "Prime index threshold: " << _primesIndexThreshold << std::endl;
+	_blockSievedPrimesIndex = std::lower_bound(_primes32.data(), _primes32.data() + _nPrimes32, sieveBlockSize/2) - _primes32.data(); // Primes with at least two factors per block for each offset
+	_blockSievedPrimesIndex += _blockSievedPrimesIndex % 2; // Needs to be even to use SIMD sieving optimizations
+	const uint64_t factorsToEliminateEntries(_parameters.pattern.size()*_primesIndexThreshold); // PatternLength entries for every prime < factorMax
+	_factorsStride = _parameters.interleavedFactors ? _parameters.sieveWorkers*_parameters.pattern.size() : _parameters.pattern.size();
+	std::cout << "Estimated additional factors: " << additionalFactorsCountEstimation << " (about " << sizeof(uint16_t)*_parameters.sieveWorkers*additionalFactorsCountEstimation << " bytes, allocated by chunks when needed)" << std::endl;
+	if (reusePrimeTable) { // The division data only depends on the primes, and the modular inverses on the primorial
+		const std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
+		_modPrecompute.swap(retainedData->modPrecompute);
+		_modPrecompute.truncate(std::min(_nPrimes, nPrimesTo2p37));
+		const bool reuseModularInverses(retainedData->primorialNumber == _parameters.primorialNumber);
+		try {
+			if (reuseModularInverses) {
+				_modularInverses32.swap(retainedData->modularInverses32);
+				_modularInverses64.swap(retainedData->modularInverses64);
+				_modularInverses32.truncate(_primes32.size());
+				_modularInverses64.truncate(_primes64.size());
 			}
-			sumInversesOfPrimes += 1./static_cast<double>(p);
+			else
+				_computeModularInverses(_primes32, _primes64, _modularInverses32, _modularInverses64, _modPrecompute, false);
 		}
+		catch (std::bad_alloc& ba) {
+			ERRORMSG("Unable to allocate memory for the modular inverses");
+			_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/4, _parameters.sieveWorkers);
+			return;
+		}
+		std::cout << "Division data reused, modular inverses " << (reuseModularInverses ? "reused" : "recomputed for the new primorial") << " in " << timeSince(t0) << " s." << std::endl;
 	}
-	if (_primesIndexThreshold == 0)
-		_primesIndexThreshold = _nPrimes;
-	std::cout << "Prime index threshold: " << _primesIndexThreshold << std::endl;
-	const uint64_t factorsToEliminateEntries(_parameters.pattern.size()*_primesIndexThreshold); // PatternLength entries for every prime < factorMax
-	additionalFactorsCountEstimation = _parameters.pattern.size()*ceil(static_cast<double>(_factorMax)*sumInversesOfPrimes);
-	const uint64_t additionalFactorsEntriesPerIteration(17ULL*(additionalFactorsCountEstimation/_parameters.sieveIterations)/16ULL + 64ULL); // Have some margin
-	std::cout << "Estimated additional factors: " << additionalFactorsCountEstimation << " (allocated per iteration: " << additionalFactorsEntriesPerIteration << ")" << std::endl;
-	{
+	else {
 		std::cout << "Precomputing modular inverses and division data..." << std::endl; // The precomputed data is used to speed up computations in _doPresieveTask.
-		t0 = std::chrono::steady_clock::now();
-		const uint64_t precompPrimes(std::min(_nPrimes, 5586502348UL)); // Precomputation only works up to p = 2^37
+		const std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
+		bool loadedFromCache;
 		try {
-			_modularInverses32.resize(_primes32.size());
-			_modularInverses64.resize(_primes64.size()); // Table of inverses of the primorial modulo a prime number in the table with index >= primorialNumber.
-			_modPrecompute.resize(precompPrimes);
+			loadedFromCache = _precomputeModularInverses(progressiveStartup ? progressiveStartupPrimeTableLimit : _parameters.primeTableLimit, _primes32, _primes64, _modularInverses32, _modularInverses64, _modPrecompute);
 		}
 		catch (std::bad_alloc& ba) {
 			ERRORMSG("Unable to allocate memory for the precomputed data");
 			_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/4, _parameters.sieveWorkers);
 			return;
 		}
-		const uint64_t blockSize((_nPrimes - _parameters.primorialNumber + _parameters.threads - 1)/_parameters.threads);
-		std::thread threads[_parameters.threads];
-		for (uint16_t j(0) ; j < _parameters.threads ; j++) {
-			threads[j] = std::thread([&, j]() {
-				mpz_class modularInverse, prime;
-				const uint64_t endIndex(std::min(_parameters.primorialNumber + (j + 1)*blockSize, _nPrimes));
-				for (uint64_t i(_parameters.primorialNumber + j*blockSize) ; i < endIndex ; i++) {
-					uint64_t p(_getPrime(i));
-					mpz_set_ui(prime.get_mpz_t(), p);
-					mpz_invert(modularInverse.get_mpz_t(), _primorial.get_mpz_t(), prime.get_mpz_t()); // modularInverse*primorial ≡ 1 (mod prime)
-					if (i < nPrimesTo2p32) _modularInverses32[i] = static_cast<uint32_t>(mpz_get_ui(modularInverse.get_mpz_t()));
-					else _modularInverses64[i - nPrimesTo2p32] = mpz_get_ui(modularInverse.get_mpz_t());
-					if (i < precompPrimes)
-						rie_mod_1s_4p_cps(&_modPrecompute[i], p);
+		std::cout << "Tables of " << _modularInverses32.size() + _modularInverses64.size() - _parameters.primorialNumber << " modular inverses and " << _modPrecompute.size() - _parameters.primorialNumber << " division entries " << (loadedFromCache ? "loaded" : "generated") << " in " << timeSince(t0) << " s (" << _modularInverses32.bytes() + _modularInverses64.bytes() + _modPrecompute.bytes() << " bytes)." << std::endl;
+	}
+	if (_parameters.compactPrimeTable && !_compactPrimeTable(_primesIndexThreshold, _primes32, _primes64, _compactPrimes))
+		return;
+	
+	const bool reuseSieves(retainedData != nullptr && retainedData->sieves.size() == _parameters.sieveWorkers && retainedData->sieveWords == _parameters.sieveWords && retainedData->sieveIterations == _parameters.sieveIterations
+	                    && factorsToEliminateEntries <= retainedData->factorsToEliminateEntries
+	                    && retainedData->interleavedFactors == _parameters.interleavedFactors);
+	if (reuseSieves) { // The allocations are large enough
+		_sieves.swap(retainedData->sieves);
+		if (_parameters.interleavedFactors) { // The pattern length, so the offsets in the shared allocation, may have changed
+			memset(_sieves[0].factorsToEliminate, 0, sizeof(uint32_t)*_parameters.sieveWorkers*factorsToEliminateEntries);
+			for (auto &sieve : _sieves)
+				sieve.factorsToEliminate = &_sieves[0].factorsToEliminate[sieve.id*_parameters.pattern.size()];
+		}
+		else {
+			for (auto &sieve : _sieves)
+				memset(sieve.factorsToEliminate, 0, sizeof(uint32_t)*factorsToEliminateEntries);
+		}
+		std::cout << "Reusing the primorial factors tables and the allocations for the primorial factors." << std::endl;
+	}
+	else {
+		try {
+			std::vector<Sieve> sieves(_parameters.sieveWorkers);
+			_sieves.swap(sieves);
+			for (std::vector<Sieve>::size_type i(0) ; i < _sieves.size() ; i++) {
+				_sieves[i].id = i;
+				_sieves[i].additionalFactorsChunks = new std::atomic<FactorsChunk*>[_factorsBuckets];
+				for (uint64_t j(0) ; j < _factorsBuckets ; j++)
+					_sieves[i].additionalFactorsChunks[j] = nullptr;
+			}
+			std::cout << "Allocating " << sizeof(uint64_t)*_parameters.sieveWorkers*_parameters.sieveWords << " bytes for the primorial factors tables..." << std::endl;
+			for (auto &sieve : _sieves)
+				sieve.factorsTable = new uint64_t[_parameters.sieveWords];
+		}
+		catch (std::bad_alloc& ba) {
+			ERRORMSG("Unable to allocate memory for the primorial factors tables");
+			_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/3, _parameters.sieveWorkers);
+			return;
+		}
+		
+		try {
+			std::cout << "Allocating " << sizeof(uint32_t)*_parameters.sieveWorkers*factorsToEliminateEntries << " bytes for the primorial factors" << (_parameters.interleavedFactors ? " (interleaved)" : "") << "..." << std::endl;
+			if (_parameters.interleavedFactors) { // A single allocation where the factors of all the Sieves for a prime are next to each other
+				uint32_t* const factorsToEliminate(reinterpret_cast<uint32_t*>(new __m256i[(_parameters.sieveWorkers*factorsToEliminateEntries + 7) / 8]));
+				memset(factorsToEliminate, 0, sizeof(uint32_t)*_parameters.sieveWorkers*factorsToEliminateEntries);
+				for (auto &sieve : _sieves)
+					sieve.factorsToEliminate = &factorsToEliminate[sieve.id*_parameters.pattern.size()];
+			}
+			else {
+				for (auto &sieve : _sieves) {
+					sieve.factorsToEliminate = reinterpret_cast<uint32_t*>(new __m256i[(factorsToEliminateEntries + 7) / 8]);
+					memset(sieve.factorsToEliminate, 0, sizeof(uint32_t)*factorsToEliminateEntries);
 				}
-			});
+			}
+		}
+		catch (std::bad_alloc& ba) {
+			ERRORMSG("Unable to allocate memory for the primorial factors");
+			_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/2, std::max(static_cast<int>(_parameters.sieveWorkers) - 1, 1));
+			return;
 		}
-		for (uint16_t j(0) ; j < _parameters.threads ; j++) threads[j].join();
-		std::cout << "Tables of " << _modularInverses32.size() + _modularInverses64.size() - _parameters.primorialNumber << " modular inverses and " << precompPrimes - _parameters.primorialNumber << " division entries generated in " << timeSince(t0) << " s (" << (_modularInverses64.size() + precompPrimes - 2*_parameters.primorialNumber)*sizeof(decltype(_modularInverses64)::value_type) + _modularInverses32.size()*sizeof(decltype(_modularInverses32)::value_type) << " bytes)." << std::endl;
 	}
-	
-	try {
-		std::vector<Sieve> sieves(_parameters.sieveWorkers);
-		_sieves.swap(sieves);
-		for (std::vector<Sieve>::size_type i(0) ; i < _sieves.size() ; i++) {
-			_sieves[i].id = i;
-			_sieves[i].additionalFactorsToEliminateCounts = new std::atomic<uint64_t>[_parameters.sieveIterations];
+	_deltaPresieve = _parameters.deltaPresieve && (_mode == "Benchmark" || _mode == "Search");
+	if (_deltaPresieve) _allocatePreviousFactors();
+	// Initial guess at a value for the threshold
+	_nRemainingCheckTasksThreshold = 32U*_parameters.threads*_parameters.sieveWorkers;
+	_inited = true;
+	if (progressiveStartup) {
+		_pendingPrimeDataReady = false;
+		_backgroundInitThread = std::thread(&Miner::_preparePendingPrimeData, this);
+	}
+	std::cout << "Done initializing miner." << std::endl;
+}
+
+
+bool Miner::_reusePrimeTable(RetainedData &retainedData, Table<uint32_t> &primes32, Table<uint64_t> &primes64) const { // The retained table is truncated if the new Prime Table Limit is lower
+	if (!retainedData.compactPrimes.empty() || _parameters.primeTableLimit > retainedData.primeTableLimit || _parameters.primeTableLimit < 1048576)
+		return false;
+	primes32.swap(retainedData.primes32);
+	primes64.swap(retainedData.primes64);
+	if (_parameters.primeTableLimit < 4294967296ULL) {
+		primes32.truncate(std::upper_bound(primes32.data(), primes32.data() + primes32.size(), _parameters.primeTableLimit) - primes32.data());
+		primes64.truncate(0);
+	}
+	else
+		primes64.truncate(std::upper_bound(primes64.data(), primes64.data() + primes64.size(), _parameters.primeTableLimit) - primes64.data());
+	if ((primes32.size() + primes64.size()) % 2 == 1) { // Needs to be even to use SIMD sieving optimizations
+		if (primes64.size() > 0) primes64.truncate(primes64.size() - 1);
+		else primes32.truncate(primes32.size() - 1);
+	}
+	std::cout << "Reusing the " << primes32.size() + primes64.size() << " first primes of the " << (retainedData.primorialNumber == 0 ? "preloaded" : "previous") << " prime table." << std::endl;
+	return true;
+}
+
+static std::string sharedPrimeTableName(const uint64_t primeTableLimit) {
+	return "rieMiner_Primes_" + std::to_string(primeTableLimit);
+}
+
+static std::string sharedPrecomputedDataName(const uint64_t primorialNumber, const uint64_t primeTableLimit) {
+	return "rieMiner_Precomputed_" + std::to_string(primorialNumber) + "_" + std::to_string(primeTableLimit);
+}
+
+bool Miner::_loadPrimeTable(const uint64_t primeTableLimit, Table<uint32_t> &primes32, Table<uint64_t> &primes64) const {
+	const bool shareTables(_parameters.sharedMemoryTables && primeTableLimit == _parameters.primeTableLimit); // Not for the small table of a progressive startup
+	const std::string sharedTablesName(sharedPrimeTableName(primeTableLimit));
+	bool mustPublish(false);
+	if (shareTables) {
+		const std::shared_ptr<const MappedFile> sharedTables(attachSharedTables(sharedTablesName, mustPublish, _parameters.threads));
+		if (sharedTables != nullptr) {
+			if (reinterpret_cast<const SharedTablesHeader*>(sharedTables->data())->nTables == 2) {
+				viewSharedTable(sharedTables, 0, primes32);
+				viewSharedTable(sharedTables, 1, primes64);
+				std::cout << primes32.size() + primes64.size() << " first primes attached from the shared memory (" << primes32.bytes() + primes64.bytes() << " bytes)." << std::endl;
+				return true;
+			}
+			std::cout << "The shared tables " << sharedTablesName << " are not usable" << std::endl;
+		}
+	}
+	if (!_loadOrGeneratePrimeTable(primeTableLimit, primes32, primes64)) {
+		if (mustPublish) removeSharedTables(sharedTablesName);
+		return false;
+	}
+	if (mustPublish) {
+		const std::shared_ptr<const MappedFile> sharedTables(publishSharedTables(sharedTablesName, {{primes32.data(), primes32.bytes()}, {primes64.data(), primes64.bytes()}}, _parameters.threads));
+		if (sharedTables != nullptr) { // Use the shared copy to not keep two
+			viewSharedTable(sharedTables, 0, primes32);
+			viewSharedTable(sharedTables, 1, primes64);
+			std::cout << "Prime table published to the shared memory as " << sharedTablesName << std::endl;
+		}
+		else
+			std::cout << "Could not publish the prime table to the shared memory" << std::endl;
+	}
+	return true;
+}
+
+bool Miner::_loadOrGeneratePrimeTable(const uint64_t primeTableLimit, Table<uint32_t> &primes32, Table<uint64_t> &primes64) const {
+	const std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
+	const std::shared_ptr<const MappedFile> primeTableMapping(std::make_shared<const MappedFile>(primeTableFile));
+	const PrimeTableFileInfo primeTableFileInfo(getPrimeTableFileInfo(*primeTableMapping));
+	bool primeTableLoaded(false);
+	if (primeTableFileInfo.version > 0 && primeTableLimit >= 1048576 && primeTableLimit <= primeTableFileInfo.limit) {
+		std::cout << "Loading prime numbers from " << primeTableFile << " (version " << primeTableFileInfo.version << ", " << primeTableMapping->size() << " bytes, " << primeTableFileInfo.nPrimes << " primes up to " << primeTableFileInfo.limit << ")..." << std::endl;
+		try {
+			primeTableLoaded = loadPrimeTableFile(primeTableMapping, primeTableLimit, primes32, primes64, _parameters.threads);
 		}
-		std::cout << "Allocating " << sizeof(uint64_t)*_parameters.sieveWorkers*_parameters.sieveWords << " bytes for the primorial factors tables..." << std::endl;
-		for (auto &sieve : _sieves)
-			sieve.factorsTable = new uint64_t[_parameters.sieveWords];
+		catch (std::bad_alloc& ba) {
+			ERRORMSG("Unable to allocate memory for the prime table");
+			_suggestLessMemoryIntensiveOptions(primeTableLimit/8, _parameters.sieveWorkers);
+			return false;
+		}
+		if (primeTableLoaded) {
+			const uint64_t mappedBytes((primes32.isView() ? primes32.bytes() : 0) + (primes64.isView() ? primes64.bytes() : 0));
+			std::cout << primes32.size() + primes64.size() << " first primes loaded in " << timeSince(t0) << " s (" << primes32.bytes() + primes64.bytes() - mappedBytes << " bytes allocated, " << mappedBytes << " bytes mapped)." << std::endl;
+		}
+		else
+			std::cout << "The file " << primeTableFile << " is corrupted, generating the table instead." << std::endl;
+	}
+	if (!primeTableLoaded) {
+		std::cout << "Generating prime table using a segmented sieve of Eratosthenes..." << std::endl;
+		try {
+			std::vector<uint32_t> generatedPrimes32;
+			std::vector<uint64_t> generatedPrimes64;
+			generatePrimeTable(primeTableLimit, generatedPrimes32, generatedPrimes64, _parameters.threads);
+			primes32.assign(std::move(generatedPrimes32));
+			primes64.assign(std::move(generatedPrimes64));
+		}
+		catch (std::bad_alloc& ba) {
+			ERRORMSG("Unable to allocate memory for the prime table");
+			_suggestLessMemoryIntensiveOptions(primeTableLimit/8, _parameters.sieveWorkers);
+			return false;
+		}
+		std::cout << "Table with all " << primes32.size() + primes64.size() << " first primes generated in " << timeSince(t0) << " s (" << primes32.bytes() + primes64.bytes() << " bytes)." << std::endl;
+	}
+
+	if ((primes32.size() + primes64.size()) % 2 == 1) { // Needs to be even to use SIMD sieving optimizations
+		if (primes64.size() > 0) primes64.truncate(primes64.size() - 1);
+		else primes32.truncate(primes32.size() - 1);
+	}
+	return true;
+}
+
+bool Miner::_compactPrimeTable(const uint64_t firstIndex, Table<uint32_t> &primes32, Table<uint64_t> &primes64, CompactPrimeTable &compactPrimes) const {
+	const std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
+	const uint64_t tableBytes(primes32.bytes() + primes64.bytes());
+	try {
+		compactPrimes.build(firstIndex, primes32, primes64, _parameters.threads);
 	}
 	catch (std::bad_alloc& ba) {
-		ERRORMSG("Unable to allocate memory for the primorial factors tables");
-		_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/3, _parameters.sieveWorkers);
-		return;
+		ERRORMSG("Unable to allocate memory for the compact prime table");
+		_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/2, _parameters.sieveWorkers);
+		return false;
+	}
+	if (compactPrimes.empty()) return true;
+	primes32.shrink(std::min(firstIndex, primes32.size()));
+	primes64.shrink(firstIndex > primes32.size() ? firstIndex - primes32.size() : 0);
+	std::cout << "Compact prime table with the " << compactPrimes.size() << " primes from index " << firstIndex << " made in " << timeSince(t0) << " s, prime table size reduced from " << tableBytes << " to " << primes32.bytes() + primes64.bytes() + compactPrimes.bytes() << " bytes." << std::endl;
+	return true;
+}
+
+void Miner::_computePrimesIndexThreshold(const Table<uint32_t> &primes32, const Table<uint64_t> &primes64, uint64_t &primesIndexThreshold, uint64_t &additionalFactorsCountEstimation) const {
+	// additionalFactorsCountEstimation = tupleSize*factorMax*(sum of 1/p, for p in the prime table >= factorMax); it is the estimation of how many such p will eliminate a factor (factorMax/p being the probability of the modulo p being < factorMax)
+	const uint64_t nPrimes(primes32.size() + primes64.size());
+	double sumInversesOfPrimes(0.);
+	primesIndexThreshold = 0; // Number of prime numbers smaller than factorMax in the table
+	for (uint64_t i(0) ; i < nPrimes ; i++) {
+		const uint64_t p(i < primes32.size() ? primes32[i] : primes64[i - primes32.size()]);
+		if (p >= _factorMax) {
+			if (primesIndexThreshold == 0) {
+				primesIndexThreshold = i;
+				if (primesIndexThreshold % 2 == 1) // Needs to be even to use SIMD sieving optimizations
+					primesIndexThreshold--;
+			}
+			sumInversesOfPrimes += 1./static_cast<double>(p);
+		}
+	}
+	if (primesIndexThreshold == 0)
+		primesIndexThreshold = nPrimes;
+	additionalFactorsCountEstimation = _parameters.pattern.size()*ceil(static_cast<double>(_factorMax)*sumInversesOfPrimes);
+}
+
+bool Miner::_precomputeModularInverses(const uint64_t primeTableLimit, const Table<uint32_t> &primes32, const Table<uint64_t> &primes64, Table<uint32_t> &modularInverses32, Table<uint64_t> &modularInverses64, Table<uint64_t> &modPrecompute) const { // Returns true if the data was loaded from the cache or the shared memory
+	const bool shareTables(_parameters.sharedMemoryTables && primeTableLimit == _parameters.primeTableLimit);
+	const std::string sharedTablesName(sharedPrecomputedDataName(_parameters.primorialNumber, primeTableLimit));
+	bool mustPublish(false);
+	if (shareTables) {
+		const std::shared_ptr<const MappedFile> sharedTables(attachSharedTables(sharedTablesName, mustPublish, _parameters.threads));
+		if (sharedTables != nullptr) {
+			const SharedTablesHeader &header(*reinterpret_cast<const SharedTablesHeader*>(sharedTables->data()));
+			if (header.nTables == 3 && header.bytes[0] == primes32.bytes() && header.bytes[1] == primes64.bytes() && header.bytes[2] == sizeof(uint64_t)*std::min(primes32.size() + primes64.size(), nPrimesTo2p37)) {
+				viewSharedTable(sharedTables, 0, modularInverses32);
+				viewSharedTable(sharedTables, 1, modularInverses64);
+				viewSharedTable(sharedTables, 2, modPrecompute);
+				std::cout << "Precomputed data attached from the shared memory" << std::endl;
+				return true;
+			}
+			std::cout << "The shared tables " << sharedTablesName << " are not usable" << std::endl;
+		}
 	}
-	
 	try {
-		std::cout << "Allocating " << sizeof(uint32_t)*_parameters.sieveWorkers*factorsToEliminateEntries << " bytes for the primorial factors..." << std::endl;
-		for (auto &sieve : _sieves) {
-			sieve.factorsToEliminate = reinterpret_cast<uint32_t*>(new __m256i[(factorsToEliminateEntries + 7) / 8]);
-			memset(sieve.factorsToEliminate, 0, sizeof(uint32_t)*factorsToEliminateEntries);
+		const bool loadedFromCache(_loadOrPrecomputeModularInverses(primeTableLimit, primes32, primes64, modularInverses32, modularInverses64, modPrecompute));
+		if (mustPublish) {
+			const std::shared_ptr<const MappedFile> sharedTables(publishSharedTables(sharedTablesName, {{modularInverses32.data(), modularInverses32.bytes()}, {modularInverses64.data(), modularInverses64.bytes()}, {modPrecompute.data(), modPrecompute.bytes()}}, _parameters.threads));
+			if (sharedTables != nullptr) {
+				viewSharedTable(sharedTables, 0, modularInverses32);
+				viewSharedTable(sharedTables, 1, modularInverses64);
+				viewSharedTable(sharedTables, 2, modPrecompute);
+				std::cout << "Precomputed data published to the shared memory as " << sharedTablesName << std::endl;
+			}
+			else
+				std::cout << "Could not publish the precomputed data to the shared memory" << std::endl;
 		}
+		return loadedFromCache;
 	}
 	catch (std::bad_alloc& ba) {
-		ERRORMSG("Unable to allocate memory for the primorial factors");
-		_suggestLessMemoryIntensiveOptions(_parameters.primeTableLimit/2, std::max(static_cast<int>(_parameters.sieveWorkers) - 1, 1));
-		return;
+		if (mustPublish) removeSharedTables(sharedTablesName); // Else other instances would wait for it forever
+		throw;
 	}
-	
+}
+
+bool Miner::_loadOrPrecomputeModularInverses(const uint64_t primeTableLimit, const Table<uint32_t> &primes32, const Table<uint64_t> &primes64, Table<uint32_t> &modularInverses32, Table<uint64_t> &modularInverses64, Table<uint64_t> &modPrecompute) const {
+	const bool useCache(_parameters.cachePrecomputedData && primeTableLimit == _parameters.primeTableLimit); // Not for the small table of a progressive startup, which is quickly computed
+	if (useCache && _loadPrecomputedData(primeTableLimit, primes32, primes64, modularInverses32, modularInverses64, modPrecompute))
+		return true;
+	_computeModularInverses(primes32, primes64, modularInverses32, modularInverses64, modPrecompute, true);
+	if (useCache)
+		_savePrecomputedData(primeTableLimit, primes32, modularInverses32, modularInverses64, modPrecompute);
+	return false;
+}
+
+void Miner::_computeModularInverses(const Table<uint32_t> &primes32, const Table<uint64_t> &primes64, Table<uint32_t> &modularInverses32, Table<uint64_t> &modularInverses64, Table<uint64_t> &modPrecompute, const bool computeDivisionData) const {
+	const uint64_t nPrimes(primes32.size() + primes64.size()),
+	               precompPrimes(std::min(nPrimes, nPrimesTo2p37)); // Precomputation only works up to p = 2^37
+	modularInverses32.resize(primes32.size());
+	modularInverses64.resize(primes64.size()); // Table of inverses of the primorial modulo a prime number in the table with index >= primorialNumber.
+	if (computeDivisionData) {
+		modPrecompute.resize(precompPrimes);
+		for (uint64_t i(0) ; i < std::min(_parameters.primorialNumber, precompPrimes) ; i++) // Also for the primes of the primorial, so the division data is still complete if reused after a retune lowering the Primorial Number
+			rie_mod_1s_4p_cps(&modPrecompute[i], primes32[i]);
+	}
+	const uint64_t blockSize((nPrimes - _parameters.primorialNumber + _parameters.threads - 1)/_parameters.threads);
+	std::thread threads[_parameters.threads];
+	for (uint16_t j(0) ; j < _parameters.threads ; j++) {
+		threads[j] = std::thread([&, j]() {
+			const mp_limb_t *primorialLimbs(_primorial.get_mpz_t()->_mp_d);
+			const mp_size_t primorialSize(_primorial.get_mpz_t()->_mp_size);
+			const uint64_t endIndex(std::min(_parameters.primorialNumber + (j + 1)*blockSize, nPrimes));
+			for (uint64_t i(_parameters.primorialNumber + j*blockSize) ; i < endIndex ; i++) {
+				// The primorial is first reduced modulo p with the same assembly optimized code as the presieve, then inverted with single word arithmetic, instead of a big number Gcd for every prime.
+				const uint64_t p(i < primes32.size() ? primes32[i] : primes64[i - primes32.size()]);
+				uint64_t primorialModP;
+				if (i < precompPrimes) {
+					if (computeDivisionData) rie_mod_1s_4p_cps(&modPrecompute[i], p);
+					const uint64_t cnt(__builtin_clzll(p));
+					primorialModP = rie_mod_1s_4p(primorialLimbs, primorialSize, p << cnt, cnt, &modPrecompute[i]) >> cnt;
+				}
+				else primorialModP = mpn_mod_1(primorialLimbs, primorialSize, p);
+				if (i < primes32.size()) modularInverses32[i] = invert(static_cast<uint32_t>(primorialModP), static_cast<uint32_t>(p)); // modularInverse*primorial ≡ 1 (mod prime)
+				else modularInverses64[i - primes32.size()] = invert(primorialModP, p);
+			}
+		});
+	}
+	for (uint16_t j(0) ; j < _parameters.threads ; j++) threads[j].join();
+}
+
+// Single file, replaced when the parameters or the version in its header do not match, so retunes do not accumulate files of several GB.
+// Layout of the file: header, modular inverses < 2^32 (padded to a multiple of 8 bytes), other modular inverses, then the division data
+struct PrecomputedDataFileHeader {
+	char magic[8]; // "RIEPRECO"
+	uint32_t version, reserved;
+	uint64_t primorialNumber, primeTableLimit, nPrimes32, nPrimes64, nPrecomputed;
+	uint64_t checksum; // Of the three tables' checksums
+};
+constexpr char precomputedDataFileMagic[8] = {'R', 'I', 'E', 'P', 'R', 'E', 'C', 'O'};
+constexpr uint32_t precomputedDataFileVersion(2); // The version 1 files lack the division data of the primes of the primorial
+
+bool Miner::_loadPrecomputedData(const uint64_t primeTableLimit, const Table<uint32_t> &primes32, const Table<uint64_t> &primes64, Table<uint32_t> &modularInverses32, Table<uint64_t> &modularInverses64, Table<uint64_t> &modPrecompute) const {
+	const std::string path(precomputedDataFile);
+	const std::shared_ptr<const MappedFile> mappedFile(std::make_shared<const MappedFile>(path));
+	if (!mappedFile->isValid() || mappedFile->size() < sizeof(PrecomputedDataFileHeader))
+		return false;
+	const PrecomputedDataFileHeader &header(*reinterpret_cast<const PrecomputedDataFileHeader*>(mappedFile->data()));
+	const uint64_t inverses64Offset(sizeof(PrecomputedDataFileHeader) + ((header.nPrimes32*sizeof(uint32_t) + 7ULL) & ~7ULL)),
+	               precomputedOffset(inverses64Offset + header.nPrimes64*sizeof(uint64_t));
+	if (std::memcmp(header.magic, precomputedDataFileMagic, sizeof(precomputedDataFileMagic)) != 0 || header.version != precomputedDataFileVersion
+	 || header.primorialNumber != _parameters.primorialNumber || header.primeTableLimit != primeTableLimit
+	 || header.nPrimes32 != primes32.size() || header.nPrimes64 != primes64.size() || header.nPrecomputed != std::min(primes32.size() + primes64.size(), nPrimesTo2p37)
+	 || precomputedOffset + header.nPrecomputed*sizeof(uint64_t) != mappedFile->size()) {
+		std::cout << "The cache file " << path << " does not match the current parameters, it will be replaced." << std::endl;
+		return false;
+	}
+	std::cout << "Loading precomputed data from " << path << " (" << mappedFile->size() << " bytes)..." << std::endl;
+	mappedFile->willNeed(0, mappedFile->size());
+	const uint32_t* const inverses32(reinterpret_cast<const uint32_t*>(mappedFile->data() + sizeof(PrecomputedDataFileHeader)));
+	const uint64_t* const inverses64(reinterpret_cast<const uint64_t*>(mappedFile->data() + inverses64Offset));
+	const uint64_t* const precomputed(reinterpret_cast<const uint64_t*>(mappedFile->data() + precomputedOffset));
+	const std::array<uint64_t, 3> checksums{parallelChecksum(inverses32, header.nPrimes32, _parameters.threads), parallelChecksum(inverses64, header.nPrimes64, _parameters.threads), parallelChecksum(precomputed, header.nPrecomputed, _parameters.threads)};
+	if (checksum(checksums.data(), checksums.size()) != header.checksum) {
+		std::cout << "The cache file " << path << " is corrupted, ignoring it." << std::endl;
+		return false;
+	}
+	modularInverses32.view(mappedFile, sizeof(PrecomputedDataFileHeader), header.nPrimes32);
+	modularInverses64.view(mappedFile, inverses64Offset, header.nPrimes64);
+	modPrecompute.view(mappedFile, precomputedOffset, header.nPrecomputed);
+	return true;
+}
+
+void Miner::_savePrecomputedData(const uint64_t primeTableLimit, const Table<uint32_t> &primes32, const Table<uint32_t> &modularInverses32, const Table<uint64_t> &modularInverses64, const Table<uint64_t> &modPrecompute) const {
+	const std::string path(precomputedDataFile);
+	PrecomputedDataFileHeader header{};
+	std::memcpy(header.magic, precomputedDataFileMagic, sizeof(precomputedDataFileMagic));
+	header.version = precomputedDataFileVersion;
+	header.primorialNumber = _parameters.primorialNumber;
+	header.primeTableLimit = primeTableLimit;
+	header.nPrimes32 = primes32.size();
+	header.nPrimes64 = modularInverses64.size();
+	header.nPrecomputed = modPrecompute.size();
+	const std::array<uint64_t, 3> checksums{parallelChecksum(modularInverses32.data(), modularInverses32.size(), _parameters.threads), parallelChecksum(modularInverses64.data(), modularInverses64.size(), _parameters.threads), parallelChecksum(modPrecompute.data(), modPrecompute.size(), _parameters.threads)};
+	header.checksum = checksum(checksums.data(), checksums.size());
+	std::ofstream file(path + ".tmp", std::ios::out | std::ios::binary | std::ios::trunc); // Written under another name then renamed, so other instances never see a partial file
+	const uint64_t padding(0ULL);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(modularInverses32.data()), modularInverses32.bytes());
+	file.write(reinterpret_cast<const char*>(&padding), ((modularInverses32.bytes() + 7ULL) & ~7ULL) - modularInverses32.bytes());
+	file.write(reinterpret_cast<const char*>(modularInverses64.data()), modularInverses64.bytes());
+	file.write(reinterpret_cast<const char*>(modPrecompute.data()), modPrecompute.bytes());
+	file.close();
+#ifdef _WIN32
+	std::remove(path.c_str()); // Rename does not replace an existing file on Windows
+#endif
+	if (file.fail() || std::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+		ERRORMSG("Could not write the cache file " << path);
+		std::remove((path + ".tmp").c_str());
+	}
+	else
+		std::cout << "Precomputed data saved to " << path << std::endl;
+}
+
+static void blockStopSignals() { // For background threads: the signal handler stops the miner, which joins them, so it must not run there
+#ifndef _WIN32
+	sigset_t signalSet;
+	sigemptyset(&signalSet);
+	sigaddset(&signalSet, SIGINT);
+	sigaddset(&signalSet, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signalSet, nullptr);
+#endif
+}
+
+void Miner::preload(const MinerParameters &minerParameters) { // Loads the prime table and computes the division data in the background, while the client connects, as they do not depend on the Job
+	if (_inited || _preloadThread.joinable() || minerParameters.cachePrecomputedData || minerParameters.sharedMemoryTables) // The precomputed data would be loaded or attached faster
+		return;
+	const uint16_t threads(minerParameters.threads != 0 ? minerParameters.threads : std::max(std::thread::hardware_concurrency(), 1U));
+	const uint64_t primeTableLimit(minerParameters.primeTableLimit != 0 ? minerParameters.primeTableLimit : primeTableLimitMax); // The automatic limit is not larger, and if smaller, the table will be truncated
+	std::cout << "Preloading the prime table up to " << primeTableLimit << " and the division data while connecting..." << std::endl;
+	_preloadedDataReady = false;
+	_preloadThread = std::thread([this, threads, primeTableLimit]() { // Only uses its own data as the Miner is initialized meanwhile
+		blockStopSignals();
+		const std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
+		std::unique_ptr<RetainedData> preloadedData(std::make_unique<RetainedData>());
+		try {
+			const std::shared_ptr<const MappedFile> primeTableMapping(std::make_shared<const MappedFile>(primeTableFile));
+			const PrimeTableFileInfo primeTableFileInfo(getPrimeTableFileInfo(*primeTableMapping));
+			if (primeTableFileInfo.version == 0 || primeTableLimit > primeTableFileInfo.limit || !loadPrimeTableFile(primeTableMapping, primeTableLimit, preloadedData->primes32, preloadedData->primes64, threads)) {
+				std::vector<uint32_t> generatedPrimes32;
+				std::vector<uint64_t> generatedPrimes64;
+				generatePrimeTable(primeTableLimit, generatedPrimes32, generatedPrimes64, threads);
+				preloadedData->primes32.assign(std::move(generatedPrimes32));
+				preloadedData->primes64.assign(std::move(generatedPrimes64));
+			}
+			const Table<uint32_t> &primes32(preloadedData->primes32);
+			const Table<uint64_t> &primes64(preloadedData->primes64);
+			Table<uint64_t> &modPrecompute(preloadedData->modPrecompute);
+			modPrecompute.resize(std::min(primes32.size() + primes64.size(), nPrimesTo2p37));
+			constexpr uint64_t blockSize(65536);
+			parallelFor((modPrecompute.size() + blockSize - 1)/blockSize, threads, [&](const uint64_t block) {
+				for (uint64_t i(block*blockSize) ; i < std::min((block + 1)*blockSize, modPrecompute.size()) ; i++)
+					rie_mod_1s_4p_cps(&modPrecompute[i], i < primes32.size() ? primes32[i] : primes64[i - primes32.size()]);
+			});
+		}
+		catch (std::bad_alloc& ba) {
+			std::cout << "Not enough memory to preload the prime table, it will be done during the initialization" << std::endl;
+			_preloadedDataReady = true;
+			return;
+		}
+		preloadedData->primeTableLimit = primeTableLimit; // The primorial is not known yet, so there are no modular inverses
+		std::cout << "Preloaded " << preloadedData->primes32.size() + preloadedData->primes64.size() << " primes and the division data in " << timeSince(t0) << " s." << std::endl;
+		_preloadedData = std::move(preloadedData);
+		_preloadedDataReady = true;
+	});
+}
+
+void Miner::_preparePendingPrimeData() { // Runs in the background during a progressive startup, the Miner's current data is not modified here
+	blockStopSignals();
+	const std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
+	std::unique_ptr<PendingPrimeData> pendingPrimeData(std::make_unique<PendingPrimeData>());
+	PendingPrimeData &pending(*pendingPrimeData);
+	if (_preloadThread.joinable()) // The mining started before the end of the preload, continue with its data
+		_preloadThread.join();
+	const std::unique_ptr<RetainedData> preloadedData(std::move(_preloadedData));
+	const bool usePreloadedData(preloadedData != nullptr && _reusePrimeTable(*preloadedData, pending.primes32, pending.primes64));
+	if (!usePreloadedData && !_loadPrimeTable(_parameters.primeTableLimit, pending.primes32, pending.primes64))
+		return;
+	pending.nPrimes32 = pending.primes32.size();
+	pending.nPrimes = pending.nPrimes32 + pending.primes64.size();
+	uint64_t additionalFactorsCountEstimation;
+	_computePrimesIndexThreshold(pending.primes32, pending.primes64, pending.primesIndexThreshold, additionalFactorsCountEstimation); // The arena of the additional factors grows by itself
+	const uint64_t factorsToEliminateEntries(_parameters.pattern.size()*pending.primesIndexThreshold);
 	try {
-		std::cout << "Allocating " << sizeof(uint32_t)*_parameters.sieveWorkers*_parameters.sieveIterations*additionalFactorsEntriesPerIteration << " bytes for the additional primorial factors..." << std::endl;
-		for (auto &sieve : _sieves) {
-			sieve.additionalFactorsToEliminate = new uint32_t*[_parameters.sieveIterations];
-			for (uint64_t j(0) ; j < _parameters.sieveIterations ; j++)
-				sieve.additionalFactorsToEliminate[j] = new uint32_t[additionalFactorsEntriesPerIteration];
+		if (usePreloadedData) {
+			pending.modPrecompute.swap(preloadedData->modPrecompute);
+			pending.modPrecompute.truncate(std::min(pending.nPrimes, nPrimesTo2p37));
+			_computeModularInverses(pending.primes32, pending.primes64, pending.modularInverses32, pending.modularInverses64, pending.modPrecompute, false);
+		}
+		else
+			_precomputeModularInverses(_parameters.primeTableLimit, pending.primes32, pending.primes64, pending.modularInverses32, pending.modularInverses64, pending.modPrecompute);
+		if (_parameters.compactPrimeTable && !_compactPrimeTable(pending.primesIndexThreshold, pending.primes32, pending.primes64, pending.compactPrimes))
+			return;
+		for (uint16_t i(0) ; i < (_parameters.interleavedFactors ? 1 : _parameters.sieveWorkers) ; i++) {
+			const uint64_t entries(_parameters.interleavedFactors ? _parameters.sieveWorkers*factorsToEliminateEntries : factorsToEliminateEntries);
+			pending.factorsToEliminate.push_back(reinterpret_cast<uint32_t*>(new __m256i[(entries + 7) / 8]));
+			memset(pending.factorsToEliminate.back(), 0, sizeof(uint32_t)*entries);
 		}
 	}
 	catch (std::bad_alloc& ba) {
-		ERRORMSG("Unable to allocate memory for the additional primorial factors");
-		_suggestLessMemoryIntensiveOptions(2*_parameters.primeTableLimit/3, std::max(static_cast<int>(_parameters.sieveWorkers) - 1, 1));
+		ERRORMSG("Unable to allocate memory for the full prime table, continuing with the current one");
 		return;
 	}
-	// Initial guess at a value for the threshold
-	_nRemainingCheckTasksThreshold = 32U*_parameters.threads*_parameters.sieveWorkers;
-	_inited = true;
-	std::cout << "Done initializing miner." << std::endl;
+	std::cout << Stats::formattedTime(_statManager.timeSinceStart()) << " Full prime table with " << pending.nPrimes << " primes prepared in " << FIXED(3) << timeSince(t0) << " s, it will be used from the next job" << std::endl;
+	_pendingPrimeData = std::move(pendingPrimeData);
+	_pendingPrimeDataReady = true;
+}
+
+void Miner::_swapInPendingPrimeData() { // Must only be called by the master thread between jobs, when no Presieve or Sieve Task is being done
+	if (_backgroundInitThread.joinable()) _backgroundInitThread.join();
+	PendingPrimeData &pending(*_pendingPrimeData);
+	_primes32.swap(pending.primes32);
+	_primes64.swap(pending.primes64);
+	_compactPrimes.swap(pending.compactPrimes);
+	_primeTableLimit = _parameters.primeTableLimit;
+	_modularInverses32.swap(pending.modularInverses32);
+	_modularInverses64.swap(pending.modularInverses64);
+	_modPrecompute.swap(pending.modPrecompute);
+	std::swap(_nPrimes, pending.nPrimes);
+	std::swap(_nPrimes32, pending.nPrimes32);
+	std::swap(_primesIndexThreshold, pending.primesIndexThreshold);
+	for (std::vector<Sieve>::size_type i(0) ; i < _sieves.size() ; i++) {
+		if (_parameters.interleavedFactors) { // Only the first Sieve owns the allocation
+			if (i == 0) std::swap(_sieves[0].factorsToEliminate, pending.factorsToEliminate[0]);
+			else _sieves[i].factorsToEliminate = &_sieves[0].factorsToEliminate[i*_parameters.pattern.size()];
+		}
+		else
+			std::swap(_sieves[i].factorsToEliminate, pending.factorsToEliminate[i]);
+	}
+	_pendingPrimeData.reset(); // Frees the previous data
+	_pendingPrimeDataReady = false;
+	if (_deltaPresieve) _allocatePreviousFactors();
+}
+
+void Miner::_allocatePreviousFactors() {
+	_previousFactorsValid = false;
+	try {
+		std::cout << "Allocating " << sizeof(uint32_t)*_nPrimes32 + sizeof(uint64_t)*(_nPrimes - _nPrimes32) << " bytes for the delta presieve..." << std::endl;
+		_previousFactors32.resize(_nPrimes32);
+		_previousFactors64.resize(_nPrimes - _nPrimes32);
+	}
+	catch (std::bad_alloc& ba) {
+		ERRORMSG("Unable to allocate memory for the delta presieve, disabling it");
+		_previousFactors32 = std::vector<uint32_t>();
+		_previousFactors64 = std::vector<uint64_t>();
+		_deltaPresieve = false;
+	}
 }
 
 void Miner::startThreads() {
@@ -350,11 +1008,23 @@ void Miner::startThreads() {
 		if (!_keepStats)
 			_statManager.start(_parameters.pattern.size());
 		_keepStats = false;
-		std::cout << "Starting the miner's master thread..." << std::endl;
-		_masterThread = std::thread(&Miner::_manageTasks, this);
-		std::cout << "Starting " << _parameters.threads << " miner's worker threads..." << std::endl;
-		for (uint16_t i(0) ; i < _parameters.threads ; i++)
-			_workerThreads.push_back(std::thread(&Miner::_doTasks, this, i));
+		if (_workerThreads.size() != _parameters.threads) // The number of threads changed, recreate them
+			_endThreads();
+		_presieveRanges = std::make_unique<PresieveRange[]>(_parameters.threads);
+		std::lock_guard<std::mutex> lock(_threadsMutex);
+		if (!_masterThread.joinable()) {
+			std::cout << "Starting the miner's master thread..." << std::endl;
+			_masterThread = std::thread(&Miner::_runPooledThread, this, 0, true, _threadsRun);
+			std::cout << "Starting " << _parameters.threads << " miner's worker threads..." << std::endl;
+			for (uint16_t i(0) ; i < _parameters.threads ; i++)
+				_workerThreads.push_back(std::thread(&Miner::_runPooledThread, this, i, false, _threadsRun));
+		}
+		else
+			std::cout << "Resuming the miner's master thread and " << _parameters.threads << " worker threads..." << std::endl;
+		_masterThreadActive = true;
+		_activeWorkerThreads = _parameters.threads;
+		_threadsRun++;
+		_threadsCondition.notify_all();
 		std::cout << "-----------------------------------------------------------" << std::endl;
 		if (_mode == "Benchmark" || _mode == "Search")
 			std::cout << Stats::formattedTime(_statManager.timeSinceStart()) << " Started " << _mode << ", difficulty " << FIXED(3) << _client->currentDifficulty() << std::endl;
@@ -372,13 +1042,13 @@ void Miner::stopThreads() {
 			printTupleStats();
 		std::cout << "Waiting for the miner's master thread to finish..." << std::endl;
 		_tasksDoneInfos.push_front(TaskDoneInfo{Task::Type::Dummy, {}}); // Unblock if master thread stuck in blocking_pop_front().
-		_masterThread.join();
+		std::unique_lock<std::mutex> lock(_threadsMutex);
+		_threadsCondition.wait(lock, [this]() {return !_masterThreadActive;});
 		std::cout << "Waiting for the miner's worker threads to finish..." << std::endl;
 		for (uint16_t i(0) ; i < _parameters.threads ; i++)
 			_tasks.push_front(Task{Task::Type::Dummy, 0, {}}); // Unblock worker threads stuck in blocking_pop_front().
-		for (auto &workerThread : _workerThreads)
-			workerThread.join();
-		_workerThreads.clear();
+		_threadsCondition.wait(lock, [this]() {return _activeWorkerThreads == 0;});
+		lock.unlock();
 		std::cout << "Miner threads stopped." << std::endl;
 		_presieveTasks.clear();
 		_tasks.clear();
@@ -387,7 +1057,65 @@ void Miner::stopThreads() {
 	}
 }
 
-void Miner::clear() {
+void Miner::_runPooledThread(const uint16_t id, const bool master, uint64_t run) { // Runs the master or a worker thread for each run, parks in between
+	blockStopSignals(); // The handler waits for the threads to park
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_threadsMutex);
+			_threadsCondition.wait(lock, [&]() {return _threadsRun != run || _threadsShouldExit;});
+			if (_threadsShouldExit)
+				break;
+			run = _threadsRun;
+		}
+		if (master) _manageTasks();
+		else _doTasks(id);
+		{
+			std::lock_guard<std::mutex> lock(_threadsMutex);
+			if (master) _masterThreadActive = false;
+			else _activeWorkerThreads--;
+		}
+		_threadsCondition.notify_all();
+	}
+	// Thread clean up.
+	for (int i(0) ; i < factorsCacheSieveWorkers ; i++)
+		delete[] factorsCache[i];
+	delete[] factorsCache;
+	delete[] factorsBucketsEnds;
+	delete[] factorsSorted;
+}
+
+void Miner::_endThreads() { // Must not be running
+	if (!_masterThread.joinable())
+		return;
+	{
+		std::lock_guard<std::mutex> lock(_threadsMutex);
+		_threadsShouldExit = true;
+	}
+	_threadsCondition.notify_all();
+	_masterThread.join();
+	for (auto &workerThread : _workerThreads)
+		workerThread.join();
+	_workerThreads.clear();
+	_threadsShouldExit = false;
+}
+
+Miner::~Miner() {
+	stop();
+	_endThreads();
+	if (_preloadThread.joinable())
+		_preloadThread.join();
+}
+
+RetainedData::~RetainedData() {
+	for (auto &sieve : sieves) {
+		delete[] sieve.factorsTable;
+		if (!interleavedFactors || sieve.id == 0)
+			delete[] reinterpret_cast<__m256i*>(sieve.factorsToEliminate);
+		delete[] sieve.additionalFactorsChunks;
+	}
+}
+
+void Miner::clear(const bool retainData) {
 	if (_running)
 		ERRORMSG("Cannot clear the miner while it is running");
 	else if (!_inited)
@@ -395,63 +1123,259 @@ void Miner::clear() {
 	else {
 		std::cout << "Clearing miner's data..." << std::endl;
 		_inited = false;
+		if (_backgroundInitThread.joinable()) {
+			std::cout << "Waiting for the background initialization to finish..." << std::endl;
+			_backgroundInitThread.join();
+		}
+		if (_preloadThread.joinable()) // The progressive startup was stopped before using the preload
+			_preloadThread.join();
+		_preloadedData.reset();
+		if (retainData && _pendingPrimeDataReady) // Retain the full prime table if it is ready
+			_swapInPendingPrimeData();
+		_pendingPrimeData.reset();
+		_pendingPrimeDataReady = false;
+		_retainedData.reset();
+		if (retainData) {
+			_retainedData = std::make_unique<RetainedData>();
+			RetainedData &retainedData(*_retainedData);
+			retainedData.primeTableLimit = _primeTableLimit;
+			retainedData.primorialNumber = _parameters.primorialNumber;
+			retainedData.sieveWords = _parameters.sieveWords;
+			retainedData.sieveIterations = _parameters.sieveIterations;
+			retainedData.factorsToEliminateEntries = _parameters.pattern.size()*_primesIndexThreshold;
+			retainedData.interleavedFactors = _parameters.interleavedFactors;
+			retainedData.primes32.swap(_primes32);
+			retainedData.primes64.swap(_primes64);
+			retainedData.compactPrimes.swap(_compactPrimes);
+			retainedData.modularInverses32.swap(_modularInverses32);
+			retainedData.modularInverses64.swap(_modularInverses64);
+			retainedData.modPrecompute.swap(_modPrecompute);
+			retainedData.sieves.swap(_sieves);
+		}
 		for (auto &sieve : _sieves) {
-			delete sieve.factorsTable;
-			delete sieve.factorsToEliminate;
-			for (uint64_t j(0) ; j < _parameters.sieveIterations ; j++)
-				delete sieve.additionalFactorsToEliminate[j];
-			delete sieve.additionalFactorsToEliminate;
-			delete sieve.additionalFactorsToEliminateCounts;
+			delete[] sieve.factorsTable;
+			if (!_parameters.interleavedFactors || sieve.id == 0)
+				delete[] reinterpret_cast<__m256i*>(sieve.factorsToEliminate);
+			delete[] sieve.additionalFactorsChunks;
 		}
 		_sieves.clear();
+		if (!retainData) // Else, the chunks already allocated are reused by the next run
+			_additionalFactorsArena.clear();
 		_primes32.clear();
 		_primes64.clear();
+		_compactPrimes.clear();
 		_modularInverses32.clear();
 		_modularInverses64.clear();
 		_modPrecompute.clear();
 		_primorialOffsets.clear();
 		_halfPattern.clear();
 		_primorialOffsetDiff.clear();
+		_deltaPresieve = false;
+		_previousFactors32 = std::vector<uint32_t>();
+		_previousFactors64 = std::vector<uint64_t>();
+		_previousFactorsValid = false;
 		_parameters = MinerParameters();
 		std::cout << "Miner's data cleared." << std::endl;
 	}
 }
 
-void Miner::_addCachedAdditionalFactorsToEliminate(Sieve& sieve, uint64_t *factorsCache, uint64_t *factorsCacheCounts, const int factorsCacheTotalCount) {
-	for (uint64_t i(0) ; i < _parameters.sieveIterations ; i++) // Initialize the counts for use as index and update the sieve's one
-		factorsCacheCounts[i] = sieve.additionalFactorsToEliminateCounts[i].fetch_add(factorsCacheCounts[i]);
-	for (int i(0) ; i < factorsCacheTotalCount ; i++) {
-		const uint64_t factor(factorsCache[i]),
-		               sieveIteration(factor >> _parameters.sieveBits),
-		               indexInFactorsTable(factorsCacheCounts[sieveIteration]);
-		sieve.additionalFactorsToEliminate[sieveIteration][indexInFactorsTable] = factor & (_parameters.sieveSize - 1); // factor % sieveSize
-		factorsCacheCounts[sieveIteration]++;
+void Miner::_addCachedAdditionalFactorsToEliminate(Sieve& sieve, uint64_t *factorsCache, const int factorsCacheTotalCount) { // The factors are sorted by bucket with a counting sort, then every bucket's ones are added at once
+	std::fill(factorsBucketsEnds, factorsBucketsEnds + _factorsBuckets + 1, 0);
+	for (int i(0) ; i < factorsCacheTotalCount ; i++)
+		factorsBucketsEnds[(factorsCache[i] >> _factorsBucketBits) + 1]++; // The bucket also counts the ones of the previous Sieve Iterations
+	for (uint64_t bucket(0) ; bucket < _factorsBuckets ; bucket++)
+		factorsBucketsEnds[bucket + 1] += factorsBucketsEnds[bucket];
+	for (int i(0) ; i < factorsCacheTotalCount ; i++)
+		factorsSorted[factorsBucketsEnds[factorsCache[i] >> _factorsBucketBits]++] = factorsCache[i] & ((1ULL << _factorsBucketBits) - 1ULL); // Offset in the bucket
+	for (uint64_t bucket(0), start(0) ; bucket < _factorsBuckets ; start = factorsBucketsEnds[bucket], bucket++) {
+		if (factorsBucketsEnds[bucket] > start && !_addFactorsToBucket(sieve, bucket, &factorsSorted[start], factorsBucketsEnds[bucket] - start))
+			return;
 	}
-	for (uint64_t i(0) ; i < _parameters.sieveIterations ; i++)
-		factorsCacheCounts[i] = 0;
 }
 
-void Miner::_doPresieveTask(const Task &task) {
-	const uint64_t workIndex(task.workIndex), firstPrimeIndex(task.presieve.start), lastPrimeIndex(task.presieve.end);
-	const mpz_class firstCandidate(_works[workIndex].primorialMultipleStart + _primorialOffsets[0]);
-	std::array<int, maxSieveWorkers> factorsCacheTotalCounts{0};
+bool Miner::_addFactorsToBucket(Sieve& sieve, const uint64_t bucket, const uint16_t *factors, uint32_t count) { // Reserves entries in the bucket's current chunk, which is shared by all the threads so their number does not multiply the partially filled chunks
+	std::atomic<FactorsChunk*> &head(sieve.additionalFactorsChunks[bucket]);
+	FactorsChunk *chunk(head);
+	while (true) {
+		if (chunk != nullptr) {
+			const uint32_t start(chunk->count.fetch_add(count));
+			if (start < factorsChunkEntries) {
+				const uint32_t reserved(std::min(count, factorsChunkEntries - start));
+				std::copy(factors, factors + reserved, &chunk->factors[start]);
+				factors += reserved;
+				count -= reserved;
+				if (count == 0)
+					return true;
+			}
+			if (head != chunk) { // Another thread already linked a new chunk
+				chunk = head;
+				continue;
+			}
+		}
+		FactorsChunk* const newChunk(_additionalFactorsArena.claim());
+		if (newChunk == nullptr) { // The remaining factors are lost, which only lets more composite candidates go to the Fermat Tests
+			if (!_additionalFactorsArenaFull.exchange(true))
+				ERRORMSG("Could not allocate memory for the additional factors, the sieving will be less effective");
+			return false;
+		}
+		newChunk->count = 0;
+		newChunk->next = chunk;
+		while (!head.compare_exchange_weak(newChunk->next, newChunk)); // Linked even if another thread did the same meanwhile, which rarely leaves the previous one partially filled
+		chunk = newChunk;
+	}
+}
+
+template <bool primes64, bool compact> // The 32 and 64 bits ranges of the prime table and the compact part are presieved by specialized versions, without branching on the index to find the prime and its inverse
+bool Miner::_doPresieveRange(const uint64_t workIndex, const mpz_class &firstCandidate, const uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, int *factorsCacheTotalCounts) {
 	uint64_t** factorsCacheRef(factorsCache); // On Windows, caching these thread_local pointers on the stack makes a noticeable perf difference.
-	uint64_t** factorsCacheCountsRef(factorsCacheCounts);
 	const uint64_t precompLimit(_modPrecompute.size()), tupleSize(_parameters.pattern.size());
+	const uint64_t base(primes64 ? _nPrimes32 : 0); // Index of the first entry of the tables used by this range
+	const typename std::conditional<primes64, uint64_t, uint32_t>::type *primes, *modularInverses;
+	if constexpr (primes64) {
+		primes = _primes64.data();
+		modularInverses = _modularInverses64.data();
+	}
+	else {
+		primes = _primes32.data();
+		modularInverses = _modularInverses32.data();
+	}
+	const bool useAvx512(_parameters.useAvx512 && _cpuInfo.hasAVX512());
+	// The primes < 2^32 are processed by groups of 4, 8 or 16 with AVX, AVX2 or AVX-512, and the ones between 2^32 and 2^50 by groups of 32 with AVX-512 IFMA
+	const uint64_t avxWidth(primes64 ? 32 : (useAvx512 ? 16 : (_parameters.useAvx2 ? 8 : 4)));
+	const bool useAvx(primes64 ? useAvx512 && _cpuInfo.hasAVX512IFMA() : _cpuInfo.hasAVX());
+	std::vector<uint64_t> candidateDigits(primes64 && useAvx ? digits52(firstCandidate) : std::vector<uint64_t>());
 	
-	uint64_t avxLimit(0);
-	const uint64_t avxWidth(_parameters.useAvx2 ? 8 : 4);
-	if (_cpuInfo.hasAVX()) {
-		avxLimit = nPrimesTo2p32 - avxWidth;
-		avxLimit -= (avxLimit - firstPrimeIndex) & (avxWidth - 1);  // Must be enough primes in range to use AVX
+	// For large candidates, the remainder tree reduces it modulo the products of chunks of primes, then down to leaves of avxWidth primes, which are presieved using the small remainders instead of the candidate.
+	// A chunk product has about the size of the candidate. The groups of primes stay within a leaf (leafEnd is lastPrimeIndex without the tree).
+	const mpz_class *candidate(&firstCandidate);
+	const uint64_t presieveDelta(_presieveDelta), additionalPresieveDelta(_additionalPresieveDelta);
+	const bool deltaOnly((firstPrimeIndex >= _primesIndexThreshold || presieveDelta != 0) && (lastPrimeIndex <= _primesIndexThreshold || additionalPresieveDelta != 0));
+	const bool useRemainderTree(!deltaOnly && _useRemainderTree[firstPrimeIndex < _primesIndexThreshold ? 0 : (firstPrimeIndex < _nPrimes32 ? 1 : 2)]);
+	RemainderTree &remainderTree(presieveRemainderTree);
+	std::vector<uint64_t> &chunkPrimes(presieveChunkPrimes);
+	CompactPrimeTable::Decoder chunkDecoder;
+	if constexpr (compact) {
+		if (useRemainderTree) chunkDecoder = _compactPrimes.decoder(firstPrimeIndex);
 	}
+	uint64_t leafEnd(useRemainderTree ? firstPrimeIndex : lastPrimeIndex), chunkStart(firstPrimeIndex), chunkEnd(firstPrimeIndex);
+	// With the delta presieve, the new fp is the previous one minus the number of primorials between the two starts, and is stored for the next job
+	typename std::conditional<primes64, uint64_t, uint32_t>::type *previousFactors(nullptr);
+	if (_deltaPresieve) {
+		if constexpr (primes64) previousFactors = _previousFactors64.data();
+		else previousFactors = _previousFactors32.data();
+	}
+	
+	// With a compact prime table, its primes are decoded in a window covering [windowStart, windowStart + 64), with i < windowStart + 32 so the AVX code can look up to 32 primes ahead.
+	uint64_t primesWindow[64]{0}, windowStart(firstPrimeIndex);
+	CompactPrimeTable::Decoder decoder;
+	if constexpr (compact) {
+		decoder = _compactPrimes.decoder(windowStart);
+		primesWindow[0] = decoder.prime();
+		for (uint64_t j(1) ; j < 64 ; j++) primesWindow[j] = decoder.next();
+	}
+	const auto prime([&](const uint64_t j) -> uint64_t {
+		if constexpr (compact) return primesWindow[j - windowStart];
+		else return primes[j - base];
+	});
+	
+	uint64_t nextRemainder[32];
+	uint64_t nextRemainderIndex(32);
+	// The IFMA code also gives the remainders of the offsets of the other Sieve Workers, stored as nextOffsetRemainders[32*(sieveWorkerIndex - 1) + j], which avoids a division per Sieve Worker, and past precompLimit where there is no division data, a slow one
+	uint64_t nextOffsetRemainders[32*(maxSieveWorkers - 1)];
+	const uint64_t *offsetRemainders(nullptr);
+	bool batchedOffsetRemainders(false);
+	const bool offsetDiffsBatchable(std::all_of(_primorialOffsetDiff.begin(), _primorialOffsetDiff.end(), [](const uint64_t offsetDiff) {return offsetDiff < (1ULL << 52);}));
+	
+	// With AVX-512 and the usual tuple lengths, the fp and offset remainders of up to 16 primes are batched, and their factors added by the SIMD code instead of the macros below. The batches stay on one side of the threshold.
+	// For the primes < 2^32, the offset remainders are also computed by the SIMD code, for all the Sieve Workers at once.
+	using Prime = typename std::conditional<primes64, uint64_t, uint32_t>::type;
+	decltype(&factorsToEliminateAvx512<6>) factorsKernel(nullptr);
+	decltype(&additionalFactorsToEliminateAvx512<6, Prime>) additionalFactorsKernel(nullptr);
+	if (useAvx512) {
+		if (tupleSize == 6) {
+			factorsKernel = &factorsToEliminateAvx512<6>;
+			additionalFactorsKernel = &additionalFactorsToEliminateAvx512<6, Prime>;
+		}
+		else if (tupleSize == 7) {
+			factorsKernel = &factorsToEliminateAvx512<7>;
+			additionalFactorsKernel = &additionalFactorsToEliminateAvx512<7, Prime>;
+		}
+		else if (tupleSize == 8) {
+			factorsKernel = &factorsToEliminateAvx512<8>;
+			additionalFactorsKernel = &additionalFactorsToEliminateAvx512<8, Prime>;
+		}
+	}
+	Prime batchPrimes[16], batchModularInverses[16], batchFactors[16], batchOffsetRemainders[16*(maxSieveWorkers - 1)];
+	uint64_t batchSize(0);
+	const auto addBatchedFactors([&](const uint64_t batchStart) -> bool {
+		if constexpr (!primes64) {
+			if (_parameters.sieveWorkers > 1)
+				offsetRemaindersAvx512(batchPrimes, batchModularInverses, _primorialOffsetDiff.data(), _primorialOffsetDiff.size(), batchSize, batchOffsetRemainders);
+		}
+		if (batchStart < _primesIndexThreshold) {
+			if constexpr (!primes64) {
+				uint32_t* factorsToEliminate[maxSieveWorkers];
+				for (int j(0) ; j < _parameters.sieveWorkers ; j++)
+					factorsToEliminate[j] = &_sieves[j].factorsToEliminate[_factorsStride*batchStart];
+				factorsKernel(batchPrimes, batchModularInverses, batchFactors, batchOffsetRemainders, _parameters.sieveWorkers, batchSize, _halfPattern.data(), _factorsStride, factorsToEliminate);
+			}
+		}
+		else {
+			for (int j(0) ; j < _parameters.sieveWorkers ; j++) {
+				if (factorsCacheTotalCounts[j] + tupleSize*batchSize >= factorsCacheSize) {
+					if (_works[workIndex].job.height != _client->currentHeight())
+						return false;
+					_addCachedAdditionalFactorsToEliminate(_sieves[j], factorsCacheRef[j], factorsCacheTotalCounts[j]);
+					factorsCacheTotalCounts[j] = 0;
+				}
+			}
+			additionalFactorsKernel(batchPrimes, batchModularInverses, batchFactors, batchOffsetRemainders, _parameters.sieveWorkers, batchSize, _halfPattern.data(), _factorMax, factorsCacheRef, factorsCacheTotalCounts);
+		}
+		batchSize = 0;
+		return true;
+	});
 	
-	uint64_t nextRemainder[8];
-	uint64_t nextRemainderIndex(8);
 	for (uint64_t i(firstPrimeIndex) ; i < lastPrimeIndex ; i++) {
-		const uint64_t p(_getPrime(i));
+		if (batchSize == 16 || (batchSize > 0 && i == _primesIndexThreshold)) {
+			if (!addBatchedFactors(i - batchSize))
+				return false;
+		}
+		if (i == leafEnd) { // Only with the remainder tree
+			if (i == chunkEnd) {
+				const uint64_t leafBits(avxWidth*(64 - __builtin_clzll(prime(i))));
+				uint64_t leavesPerChunk(1);
+				while (leavesPerChunk*leafBits < mpz_sizeinbase(firstCandidate.get_mpz_t(), 2)) leavesPerChunk *= 2;
+				chunkStart = i;
+				chunkEnd = std::min(i + leavesPerChunk*avxWidth, lastPrimeIndex);
+				chunkPrimes.clear();
+				for (uint64_t j(chunkStart) ; j < chunkEnd ; j++) {
+					if constexpr (compact) {
+						chunkPrimes.push_back(chunkDecoder.prime());
+						chunkDecoder.next();
+					}
+					else
+						chunkPrimes.push_back(primes[j - base]);
+				}
+				remainderTree.build(chunkPrimes, avxWidth);
+				remainderTree.reduce(firstCandidate);
+			}
+			candidate = &remainderTree.remainder((i - chunkStart)/avxWidth);
+			if (primes64 && useAvx) candidateDigits = digits52(*candidate);
+			leafEnd = std::min(i + avxWidth, lastPrimeIndex);
+		}
+		uint64_t p;
+		if constexpr (compact) {
+			if (i == windowStart + 32) {
+				for (uint64_t j(0) ; j < 32 ; j++) primesWindow[j] = primesWindow[j + 32];
+				for (uint64_t j(32) ; j < 64 ; j++) primesWindow[j] = decoder.next();
+				windowStart += 32;
+			}
+			p = primesWindow[i - windowStart];
+		}
+		else
+			p = primes[i - base];
 		uint64_t mi[4];
-		mi[0] = _getModularInverse(i); // Modular inverse of the primorial: mi[0]*primorial ≡ 1 (mod p). The modularInverses were precomputed in init().
+		mi[0] = modularInverses[i - base]; // Modular inverse of the primorial: mi[0]*primorial ≡ 1 (mod p). The modularInverses were precomputed in init().
 		mi[1] = (mi[0] << 1); // mi[i] = (2*i*mi[0]) % p for i > 0.
 		if (mi[1] >= p) mi[1] -= p;
 		mi[2] = mi[1] << 1;
@@ -463,89 +1387,120 @@ void Miner::_doPresieveTask(const Task &task) {
 		// In the sieving phase, numbers of the form firstCandidate + (p*i + fp)*primorial for 0 <= i < factorMax are eliminated as they are divisible by p.
 		// This is for the first number of the constellation. Later, the mi[1-3] will be used to adjust fp for the other elements of the constellation.
 		uint64_t fp, cnt(0ULL), ps(0ULL);
-		if (i < precompLimit) { // Assembly optimized computation of fp by Michael Bell
-			bool haveRemainder(false);
-			if (nextRemainderIndex < avxWidth) {
-				fp = nextRemainder[nextRemainderIndex++];
-				cnt = __builtin_clzll(p);
-				ps = p << cnt;
-				haveRemainder = true;
+		bool haveRemainder(false);
+		offsetRemainders = nullptr;
+		const uint64_t delta(i < _primesIndexThreshold ? presieveDelta : additionalPresieveDelta);
+		if (delta != 0) { // firstCandidate + primorial*(fp - delta) ≡ previousFirstCandidate + primorial*fp ≡ 0 (mod p)
+			cnt = __builtin_clzll(p);
+			ps = p << cnt;
+			uint64_t deltaModP(delta);
+			if (deltaModP >= p) {
+				if (i < precompLimit) {
+					udiv_rnnd_preinv(deltaModP, delta >> (64ULL - cnt), delta << cnt, ps, _modPrecompute[i]);
+					deltaModP >>= cnt;
+				}
+				else
+					deltaModP %= p;
 			}
-			else if (i < avxLimit) {
-				cnt = __builtin_clz(static_cast<uint32_t>(p));
-				if (__builtin_clz(static_cast<uint32_t>(_primes32[i + avxWidth - 1])) == cnt) {
-					uint32_t ps32[8];
-					for (uint64_t j(0) ; j < avxWidth; j++) {
-						ps32[j] = static_cast<uint32_t>(_primes32[i + j]) << cnt;
-						nextRemainder[j] = _modularInverses32[i + j];
-					}
-					if (_parameters.useAvx2) rie_mod_1s_2p_8times(firstCandidate.get_mpz_t()->_mp_d, firstCandidate.get_mpz_t()->_mp_size, &ps32[0], cnt, &_modPrecompute[i], &nextRemainder[0]);
-					else rie_mod_1s_2p_4times(firstCandidate.get_mpz_t()->_mp_d, firstCandidate.get_mpz_t()->_mp_size, &ps32[0], cnt, &_modPrecompute[i], &nextRemainder[0]);
-					haveRemainder = true;
-					fp = nextRemainder[0];
-					nextRemainderIndex = 1;
-					cnt += 32ULL;
-					ps = static_cast<uint64_t>(ps32[0]) << 32ULL;
+			fp = previousFactors[i - base];
+			fp = fp >= deltaModP ? fp - deltaModP : fp + p - deltaModP;
+			haveRemainder = true;
+		}
+		else if (nextRemainderIndex < avxWidth) {
+			if (batchedOffsetRemainders) offsetRemainders = &nextOffsetRemainders[nextRemainderIndex];
+			fp = nextRemainder[nextRemainderIndex++];
+			cnt = __builtin_clzll(p);
+			ps = p << cnt;
+			haveRemainder = true;
+		}
+		else if (primes64 && useAvx && i + avxWidth <= leafEnd && prime(i + avxWidth - 1) < ifmaPrimeMax) { // Also past precompLimit, the offsets remainders for the other Sieve Workers being batched as well
+			uint64_t ps64[32];
+			for (uint64_t j(0) ; j < avxWidth; j++) {
+				ps64[j] = prime(i + j);
+				nextRemainder[j] = modularInverses[i + j - base];
+			}
+			batchedOffsetRemainders = offsetDiffsBatchable;
+			modTimesAvx512Ifma<4>(candidateDigits.data(), candidateDigits.size(), &ps64[0], &nextRemainder[0], _primorialOffsetDiff.data(), batchedOffsetRemainders ? _primorialOffsetDiff.size() : 0, &nextOffsetRemainders[0]);
+			if (batchedOffsetRemainders) offsetRemainders = &nextOffsetRemainders[0];
+			haveRemainder = true;
+			fp = nextRemainder[0];
+			nextRemainderIndex = 1;
+			cnt = __builtin_clzll(p);
+			ps = p << cnt;
+		}
+		else if (!primes64 && useAvx && i < precompLimit && i + avxWidth <= leafEnd) { // The lookahead stays in the range and the leaf
+			cnt = __builtin_clz(static_cast<uint32_t>(p));
+			if (__builtin_clz(static_cast<uint32_t>(prime(i + avxWidth - 1))) == cnt) {
+				uint32_t ps32[16];
+				for (uint64_t j(0) ; j < avxWidth; j++) {
+					ps32[j] = static_cast<uint32_t>(prime(i + j)) << cnt;
+					nextRemainder[j] = modularInverses[i + j - base];
 				}
+				if (useAvx512) mod16TimesAvx512(candidate->get_mpz_t()->_mp_d, candidate->get_mpz_t()->_mp_size, &ps32[0], cnt, &_modPrecompute[i], &nextRemainder[0]);
+				else if (_parameters.useAvx2) rie_mod_1s_2p_8times(candidate->get_mpz_t()->_mp_d, candidate->get_mpz_t()->_mp_size, &ps32[0], cnt, &_modPrecompute[i], &nextRemainder[0]);
+				else rie_mod_1s_2p_4times(candidate->get_mpz_t()->_mp_d, candidate->get_mpz_t()->_mp_size, &ps32[0], cnt, &_modPrecompute[i], &nextRemainder[0]);
+				haveRemainder = true;
+				fp = nextRemainder[0];
+				nextRemainderIndex = 1;
+				cnt += 32ULL;
+				ps = static_cast<uint64_t>(ps32[0]) << 32ULL;
 			}
-			
-			if (!haveRemainder) {
+		}
+		
+		if (!haveRemainder) {
+			if (i < precompLimit) { // Assembly optimized computation of fp by Michael Bell
 				cnt = __builtin_clzll(p);
 				ps = p << cnt;
-				const uint64_t remainder(rie_mod_1s_4p(firstCandidate.get_mpz_t()->_mp_d, firstCandidate.get_mpz_t()->_mp_size, ps, cnt, &_modPrecompute[i]));
+				const uint64_t remainder(rie_mod_1s_4p(candidate->get_mpz_t()->_mp_d, candidate->get_mpz_t()->_mp_size, ps, cnt, &_modPrecompute[i]));
 				const uint64_t pa(ps - remainder);
 				uint64_t r, n[2];
 				umul_ppmm(n[1], n[0], pa, mi[0]);
 				udiv_rnnd_preinv(r, n[1], n[0], ps, _modPrecompute[i]);
 				fp = r >> cnt;
 			}
-		}
-		else { // Basic computation of fp
-			const uint64_t remainder(mpz_tdiv_ui(firstCandidate.get_mpz_t(), p)), pa(p - remainder);
-			uint64_t q, n[2];
-			umul_ppmm(n[1], n[0], pa, mi[0]);
-			udiv_qrnnd(q, fp, n[1], n[0], p);
+			else { // Basic computation of fp
+				const uint64_t remainder(mpz_tdiv_ui(candidate->get_mpz_t(), p)), pa(p - remainder);
+				uint64_t q, n[2];
+				umul_ppmm(n[1], n[0], pa, mi[0]);
+				udiv_qrnnd(q, fp, n[1], n[0], p);
+			}
 		}
 
+		if (previousFactors != nullptr) previousFactors[i - base] = fp;
+		
 		// We use a macro here to ensure the compiler inlines the code, and also make it easier to early
 		// out of the function completely if the current height has changed.
 #define addFactorsToEliminateForP(sieveWorkerIndex) {						                                                   \
 			if (i < _primesIndexThreshold) {			                                                                       \
-				_sieves[sieveWorkerIndex].factorsToEliminate[tupleSize*i] = fp;		                                           \
+				_sieves[sieveWorkerIndex].factorsToEliminate[_factorsStride*i] = fp;                                           \
 				for (std::vector<uint64_t>::size_type f(1) ; f < _halfPattern.size() ; f++) {		                           \
 					if (fp < mi[_halfPattern[f]]) fp += p;	                                                                   \
 					fp -= mi[_halfPattern[f]];	                                                                               \
-					_sieves[sieveWorkerIndex].factorsToEliminate[tupleSize*i + f] = fp;	                                       \
+					_sieves[sieveWorkerIndex].factorsToEliminate[_factorsStride*i + f] = fp;                                   \
 				}		                                                                                                       \
 			}			                                                                                                       \
 			else {			                                                                                                   \
 				if (factorsCacheTotalCounts[sieveWorkerIndex] + _halfPattern.size() >= factorsCacheSize) {		           \
 					if (_works[workIndex].job.height != _client->currentHeight())	                                           \
-						return;                                                                                                \
-					_addCachedAdditionalFactorsToEliminate(_sieves[sieveWorkerIndex], factorsCacheRef[sieveWorkerIndex], factorsCacheCountsRef[sieveWorkerIndex], factorsCacheTotalCounts[sieveWorkerIndex]); \
+						return false;                                                                                          \
+					_addCachedAdditionalFactorsToEliminate(_sieves[sieveWorkerIndex], factorsCacheRef[sieveWorkerIndex], factorsCacheTotalCounts[sieveWorkerIndex]); \
 					factorsCacheTotalCounts[sieveWorkerIndex] = 0;	                                                   \
 				}		                                                                                                       \
-				if (fp < _factorMax) {		                                                                                   \
-					factorsCacheRef[sieveWorkerIndex][factorsCacheTotalCounts[sieveWorkerIndex]++] = fp;	   \
-					factorsCacheCountsRef[sieveWorkerIndex][fp >> _parameters.sieveBits]++;	                       \
-				}		                                                                                                       \
+				if (fp < _factorMax)                                                                                           \
+					factorsCacheRef[sieveWorkerIndex][factorsCacheTotalCounts[sieveWorkerIndex]++] = fp;                       \
 				for (std::vector<uint64_t>::size_type f(1) ; f < _halfPattern.size() ; f++) {		                           \
 					if (fp < mi[_halfPattern[f]]) fp += p;	                                                                   \
 					fp -= mi[_halfPattern[f]];	                                                                               \
-					if (fp < _factorMax) {	                                                                                   \
-						factorsCacheRef[sieveWorkerIndex][factorsCacheTotalCounts[sieveWorkerIndex]++] = fp; \
-						factorsCacheCountsRef[sieveWorkerIndex][fp >> _parameters.sieveBits]++;                    \
-					}	                                                                                                       \
+					if (fp < _factorMax)                                                                                       \
+						factorsCacheRef[sieveWorkerIndex][factorsCacheTotalCounts[sieveWorkerIndex]++] = fp;                   \
 				}		                                                                                                       \
 			}		                                                                                                           \
 		};
-		addFactorsToEliminateForP(0);
-		if (_parameters.sieveWorkers == 1) continue;
-		
 		// Recompute fp to adjust to the PrimorialOffsets of other Sieve Workers.
-		uint64_t r;
 #define recomputeFp(sieveWorkerIndex) {				                                      \
-			if (i < precompLimit && _primorialOffsetDiff[sieveWorkerIndex - 1] < p) {	  \
+			if (offsetRemainders != nullptr)                                              \
+				r = offsetRemainders[32*(sieveWorkerIndex - 1)];                          \
+			else if (i < precompLimit && _primorialOffsetDiff[sieveWorkerIndex - 1] < p) {\
 				uint64_t n[2];                                                            \
 				uint64_t os(_primorialOffsetDiff[sieveWorkerIndex - 1] << cnt);           \
 				umul_ppmm(n[1], n[0], os, mi[0]);                                         \
@@ -558,6 +1513,24 @@ void Miner::_doPresieveTask(const Task &task) {
 				udiv_qrnnd(q, r, n[1], n[0], p);                                          \
 			}                                                                             \
 		}
+		uint64_t r;
+		if (factorsKernel != nullptr) {
+			batchPrimes[batchSize] = p;
+			batchModularInverses[batchSize] = mi[0];
+			batchFactors[batchSize] = fp;
+			if constexpr (primes64) {
+				for (int j(1) ; j < _parameters.sieveWorkers ; j++) {
+					if (j == 1 || _primorialOffsetDiff[j - 1] != _primorialOffsetDiff[j - 2])
+						recomputeFp(j);
+					batchOffsetRemainders[16*(j - 1) + batchSize] = r;
+				}
+			}
+			batchSize++;
+			continue;
+		}
+		addFactorsToEliminateForP(0);
+		if (_parameters.sieveWorkers == 1) continue;
+		
 		recomputeFp(1);
 		if (fp < r) fp += p;
 		fp -= r;
@@ -571,50 +1544,141 @@ void Miner::_doPresieveTask(const Task &task) {
 			addFactorsToEliminateForP(j);
 		}
 	}
+	if (batchSize > 0 && !addBatchedFactors(lastPrimeIndex - batchSize))
+		return false;
+	
+	return true;
+}
+
+void Miner::_doPresieveTask(const Task &task) {
+	const std::chrono::time_point<std::chrono::steady_clock> t0(std::chrono::steady_clock::now());
+	const uint64_t workIndex(task.workIndex), firstPrimeIndex(task.presieve.start);
+	mpz_class firstCandidate(_works[workIndex].primorialMultipleStart + _primorialOffsets[0]);
+	if (_works[workIndex].factorStart != 0) firstCandidate += _primorial*u64ToMpz(_works[workIndex].factorStart);
+	std::array<int, maxSieveWorkers> factorsCacheTotalCounts{0};
+	const uint64_t compactStart(_compactPrimes.empty() ? _nPrimes : _compactPrimes.firstIndex());
+	const auto presieveSlice([&](const uint64_t sliceStart, const uint64_t sliceEnd) -> bool {
+		// Ranges of the 32 and 64 bits primes, before and from the compact table start, in order
+		const uint64_t end32(std::min({_nPrimes32, compactStart, sliceEnd})), start64(std::max(sliceStart, _nPrimes32)), end64(std::min(compactStart, sliceEnd));
+		const uint64_t startCompact32(std::max(sliceStart, compactStart)), endCompact32(std::min(_nPrimes32, sliceEnd)), startCompact64(std::max(startCompact32, _nPrimes32));
+		return (sliceStart >= end32 || _doPresieveRange<false, false>(workIndex, firstCandidate, sliceStart, end32, factorsCacheTotalCounts.data()))
+		    && (start64 >= end64 || _doPresieveRange<true, false>(workIndex, firstCandidate, start64, end64, factorsCacheTotalCounts.data()))
+		    && (startCompact32 >= endCompact32 || _doPresieveRange<false, true>(workIndex, firstCandidate, startCompact32, endCompact32, factorsCacheTotalCounts.data()))
+		    && (startCompact64 >= sliceEnd || _doPresieveRange<true, true>(workIndex, firstCandidate, startCompact64, sliceEnd, factorsCacheTotalCounts.data()));
+	});
+	
+	// Publish the range, then claim its primes by slices until the end, which can be lowered meanwhile by an idle thread stealing the unclaimed part
+	PresieveRange &range(_presieveRanges[threadId]);
+	{
+		std::lock_guard<std::mutex> lock(_presieveRangesMutex);
+		range.workIndex = workIndex;
+		range.start = firstPrimeIndex;
+		range.bounds = (task.presieve.end - firstPrimeIndex) << 32;
+		range.active = true;
+		_activePresieveRanges++;
+	}
+	uint64_t bounds(range.bounds), lastPrimeIndex(firstPrimeIndex);
+	bool interrupted(false);
+	while (true) {
+		const uint64_t next(bounds & 0xFFFFFFFFULL), end(bounds >> 32);
+		if (next == end || interrupted) { // Done, or close the range so nothing is stolen after an interruption
+			if (range.bounds.compare_exchange_weak(bounds, (end << 32) | end)) {
+				lastPrimeIndex = firstPrimeIndex + end;
+				break;
+			}
+			continue;
+		}
+		const uint64_t sliceEnd(std::min(next + presieveSliceSize, end));
+		if (!range.bounds.compare_exchange_weak(bounds, (end << 32) | sliceEnd))
+			continue;
+		interrupted = !presieveSlice(firstPrimeIndex + next, firstPrimeIndex + sliceEnd);
+		bounds = range.bounds;
+	}
+	{
+		std::lock_guard<std::mutex> lock(_presieveRangesMutex);
+		range.active = false;
+		_activePresieveRanges--;
+	}
+	if (interrupted)
+		_previousFactorsValid = false; // Some factors were not updated, so the next job will be presieved from scratch
+	else {
+		const uint64_t part(firstPrimeIndex < _primesIndexThreshold ? 0 : (firstPrimeIndex < _nPrimes32 ? 1 : 2)); // The Tasks do not cross these limits
+		_presieveCostNs[part] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+		_presievedPrimes[part] += lastPrimeIndex - firstPrimeIndex;
+	}
 	
-	if (lastPrimeIndex > _primesIndexThreshold) {
+	if (!interrupted && lastPrimeIndex > _primesIndexThreshold) {
 		for (int j(0) ; j < _parameters.sieveWorkers ; j++) {
 			if (factorsCacheTotalCounts[j] > 0) {
-				_addCachedAdditionalFactorsToEliminate(_sieves[j], factorsCacheRef[j], factorsCacheCountsRef[j], factorsCacheTotalCounts[j]);
+				_addCachedAdditionalFactorsToEliminate(_sieves[j], factorsCache[j], factorsCacheTotalCounts[j]);
 				factorsCacheTotalCounts[j] = 0;
 			}
 		}
 	}
+	_tasksDoneInfos.push_back(TaskDoneInfo::PresieveTaskDoneInfo(firstPrimeIndex, lastPrimeIndex));
+}
+
+bool Miner::_stealPresieveTask(Task &task, const bool belowThresholdOnly) { // Takes the unclaimed second half of the largest range being presieved, if it has enough primes
+	if (_activePresieveRanges == 0) return false;
+	std::lock_guard<std::mutex> lock(_presieveRangesMutex);
+	PresieveRange *victim(nullptr);
+	uint64_t remainingMax(2*presieveSliceSize - 1);
+	for (uint16_t i(0) ; i < _parameters.threads ; i++) {
+		const PresieveRange &range(_presieveRanges[i]);
+		const uint64_t bounds(range.bounds);
+		if (range.active && (!belowThresholdOnly || range.start < _primesIndexThreshold) && (bounds >> 32) - (bounds & 0xFFFFFFFFULL) > remainingMax) {
+			victim = &_presieveRanges[i];
+			remainingMax = (bounds >> 32) - (bounds & 0xFFFFFFFFULL);
+		}
+	}
+	if (victim == nullptr) return false;
+	uint64_t bounds(victim->bounds);
+	while (true) { // The victim may claim a slice meanwhile
+		const uint64_t next(bounds & 0xFFFFFFFFULL), end(bounds >> 32), middle(next + (end - next)/2);
+		if (end - next < 2*presieveSliceSize) return false;
+		if (victim->bounds.compare_exchange_weak(bounds, (middle << 32) | next)) {
+			task = Task::PresieveTask(victim->workIndex, victim->start + middle, victim->start + end);
+			return true;
+		}
+	}
 }
 
-void Miner::_processSieve(uint64_t *factorsTable, uint32_t* factorsToEliminate, const uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex) {
+void Miner::_processSieve(uint64_t *factorsTable, uint32_t* factorsToEliminate, const uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, const uint32_t blockEnd) {
 	const uint64_t tupleSize(_parameters.pattern.size());
+	const uint32_t iterationShift(blockEnd == _parameters.sieveSize ? _parameters.sieveSize : 0); // The factors are moved to the next Sieve Iteration only after the last block
 	std::array<uint32_t, sieveCacheSize> sieveCache{0};
 	uint64_t sieveCachePos(0);
 	for (uint64_t i(firstPrimeIndex) ; i < lastPrimeIndex ; i++) {
 		const uint32_t p(_primes32[i]);
 		for (uint64_t f(0) ; f < tupleSize; f++) {
-			while (factorsToEliminate[i*tupleSize + f] < _parameters.sieveSize) { // Eliminate primorial factors of the form p*m + fp for every m*p in the current table.
-				_addToSieveCache(factorsTable, sieveCache, sieveCachePos, factorsToEliminate[i*tupleSize + f]);
-				factorsToEliminate[i*tupleSize + f] += p; // Increment the m
+			while (factorsToEliminate[i*_factorsStride + f] < blockEnd) { // Eliminate primorial factors of the form p*m + fp for every m*p in the current table.
+				_addToSieveCache(factorsTable, sieveCache, sieveCachePos, factorsToEliminate[i*_factorsStride + f]);
+				factorsToEliminate[i*_factorsStride + f] += p; // Increment the m
 			}
-			factorsToEliminate[i*tupleSize + f] -= _parameters.sieveSize; // Prepare for the next iteration
+			factorsToEliminate[i*_factorsStride + f] -= iterationShift; // Prepare for the next iteration
 		}
 	}
 	_endSieveCache(factorsTable, sieveCache);
 }
 
-void Miner::_processSieve6(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex) { // Assembly optimized sieving for 6-tuples by Michael Bell
+void Miner::_processSieve6(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, const uint32_t blockEnd) { // Assembly optimized sieving for 6-tuples by Michael Bell
 	assert(_parameters.pattern.size() == 6);
+	const uint32_t iterationShift(blockEnd == _parameters.sieveSize ? _parameters.sieveSize : 0);
 	assert((lastPrimeIndex & 1) == 0);
 	// Already eliminate for the first prime to sieve if it is odd to align for the optimizations
 	if ((firstPrimeIndex & 1) != 0) {
 		for (uint64_t f(0) ; f < 6 ; f++) {
-			while (factorsToEliminate[firstPrimeIndex*6 + f] < _parameters.sieveSize) {
-				factorsTable[factorsToEliminate[firstPrimeIndex*6 + f] >> 6U] |= (1ULL << ((factorsToEliminate[firstPrimeIndex*6 + f] & 63U)));
-				factorsToEliminate[firstPrimeIndex*6 + f] += _primes32[firstPrimeIndex];
+			while (factorsToEliminate[firstPrimeIndex*_factorsStride + f] < blockEnd) {
+				factorsTable[factorsToEliminate[firstPrimeIndex*_factorsStride + f] >> 6U] |= (1ULL << ((factorsToEliminate[firstPrimeIndex*_factorsStride + f] & 63U)));
+				factorsToEliminate[firstPrimeIndex*_factorsStride + f] += _primes32[firstPrimeIndex];
 			}
-			factorsToEliminate[firstPrimeIndex*6 + f] -= _parameters.sieveSize;
+			factorsToEliminate[firstPrimeIndex*_factorsStride + f] -= iterationShift;
 		}
 		firstPrimeIndex++;
 	}
-	xmmreg_t offsetmax;
-	offsetmax.m128 = _mm_set1_epi32(_parameters.sieveSize);
+	xmmreg_t offsetmax, nextIteration;
+	offsetmax.m128 = _mm_set1_epi32(blockEnd);
+	nextIteration.m128 = _mm_set1_epi32(iterationShift);
 	for (uint64_t i(firstPrimeIndex) ; i < lastPrimeIndex ; i += 2) {
 		xmmreg_t p1, p2, p3;
 		xmmreg_t factor1, factor2, factor3, nextIncr1, nextIncr2, nextIncr3;
@@ -622,9 +1686,11 @@ void Miner::_processSieve6(uint64_t *factorsTable, uint32_t* factorsToEliminate,
 		p1.m128 = _mm_set1_epi32(_primes32[i]);
 		p3.m128 = _mm_set1_epi32(_primes32[i + 1]);
 		p2.m128 = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(p1.m128), _mm_castsi128_ps(p3.m128), _MM_SHUFFLE(0, 0, 0, 0)));
-		factor1.m128 = _mm_load_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*6 + 0]));
-		factor2.m128 = _mm_load_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*6 + 4]));
-		factor3.m128 = _mm_load_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*6 + 8]));
+		uint32_t* const factors1(&factorsToEliminate[i*_factorsStride]);
+		uint32_t* const factors2(&factorsToEliminate[(i + 1)*_factorsStride]); // Right after the first prime's factors, unless the layout is interleaved
+		factor1.m128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&factors1[0]));
+		factor2.m128 = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(&factors1[4])), _mm_loadl_epi64(reinterpret_cast<__m128i const*>(&factors2[0])));
+		factor3.m128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&factors2[2]));
 		while (true) {
 			cmpres1.m128 = _mm_cmpgt_epi32(offsetmax.m128, factor1.m128);
 			cmpres2.m128 = _mm_cmpgt_epi32(offsetmax.m128, factor2.m128);
@@ -652,30 +1718,33 @@ void Miner::_processSieve6(uint64_t *factorsTable, uint32_t* factorsToEliminate,
 			factor2.m128 = _mm_add_epi32(factor2.m128, nextIncr2.m128);
 			factor3.m128 = _mm_add_epi32(factor3.m128, nextIncr3.m128);
 		}
-		factor1.m128 = _mm_sub_epi32(factor1.m128, offsetmax.m128);
-		factor2.m128 = _mm_sub_epi32(factor2.m128, offsetmax.m128);
-		factor3.m128 = _mm_sub_epi32(factor3.m128, offsetmax.m128);
-		_mm_store_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*6 + 0]), factor1.m128);
-		_mm_store_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*6 + 4]), factor2.m128);
-		_mm_store_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*6 + 8]), factor3.m128);
+		factor1.m128 = _mm_sub_epi32(factor1.m128, nextIteration.m128);
+		factor2.m128 = _mm_sub_epi32(factor2.m128, nextIteration.m128);
+		factor3.m128 = _mm_sub_epi32(factor3.m128, nextIteration.m128);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&factors1[0]), factor1.m128);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(&factors1[4]), factor2.m128);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(&factors2[0]), _mm_unpackhi_epi64(factor2.m128, factor2.m128));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&factors2[2]), factor3.m128);
 	}
 }
 
-void Miner::_processSieve7(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex) { // Assembly optimized sieving for 7-tuples by Michael Bell
+void Miner::_processSieve7(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, const uint32_t blockEnd) { // Assembly optimized sieving for 7-tuples by Michael Bell
 	assert(_parameters.pattern.size() == 7);
+	const uint32_t iterationShift(blockEnd == _parameters.sieveSize ? _parameters.sieveSize : 0);
 
 	std::array<uint32_t, sieveCacheSize> sieveCache{0};
 	uint64_t sieveCachePos(0);
 
-	xmmreg_t offsetmax;
-	offsetmax.m128 = _mm_set1_epi32(_parameters.sieveSize);
+	xmmreg_t offsetmax, nextIteration;
+	offsetmax.m128 = _mm_set1_epi32(blockEnd);
+	nextIteration.m128 = _mm_set1_epi32(iterationShift);
 	for (uint64_t i(firstPrimeIndex) ; i < lastPrimeIndex ; i += 1) {
 		xmmreg_t p1;
 		xmmreg_t factor1, factor2, nextIncr1, nextIncr2;
 		xmmreg_t cmpres1, cmpres2;
 		p1.m128 = _mm_set1_epi32(_primes32[i]);
-		factor1.m128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*7 + 0]));
-		factor2.m128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*7 + 3]));
+		factor1.m128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*_factorsStride + 0]));
+		factor2.m128 = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*_factorsStride + 3]));
 		while (true) {
 			cmpres1.m128 = _mm_cmpgt_epi32(offsetmax.m128, factor1.m128);
 			cmpres2.m128 = _mm_cmpgt_epi32(offsetmax.m128, factor2.m128);
@@ -694,18 +1763,19 @@ void Miner::_processSieve7(uint64_t *factorsTable, uint32_t* factorsToEliminate,
 			factor1.m128 = _mm_add_epi32(factor1.m128, nextIncr1.m128);
 			factor2.m128 = _mm_add_epi32(factor2.m128, nextIncr2.m128);
 		}
-		factor1.m128 = _mm_sub_epi32(factor1.m128, offsetmax.m128);
-		factor2.m128 = _mm_sub_epi32(factor2.m128, offsetmax.m128);
-		_mm_storeu_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*7 + 0]), factor1.m128);
-		_mm_storeu_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*7 + 3]), factor2.m128);
+		factor1.m128 = _mm_sub_epi32(factor1.m128, nextIteration.m128);
+		factor2.m128 = _mm_sub_epi32(factor2.m128, nextIteration.m128);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*_factorsStride + 0]), factor1.m128);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*_factorsStride + 3]), factor2.m128);
 	}
 	_endSieveCache(factorsTable, sieveCache);
 }
 
-void Miner::_processSieve7_avx2(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex) { // Assembly optimized sieving for 7-tuples by Michael Bell
+void Miner::_processSieve7_avx2(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, const uint32_t blockEnd) { // Assembly optimized sieving for 7-tuples by Michael Bell
 	assert(_parameters.pattern.size() == 7);
 
 #ifdef __AVX2__
+	const uint32_t iterationShift(blockEnd == _parameters.sieveSize ? _parameters.sieveSize : 0);
 	std::array<uint32_t, sieveCacheSize> sieveCache{0};
 	uint64_t sieveCachePos(0);
 
@@ -713,28 +1783,32 @@ void Miner::_processSieve7_avx2(uint64_t *factorsTable, uint32_t* factorsToElimi
 	// Already eliminate for the first prime to sieve if it is odd to align for the optimizations
 	if ((firstPrimeIndex & 1) != 0) {
 		for (uint64_t f(0) ; f < 7 ; f++) {
-			while (factorsToEliminate[firstPrimeIndex*7 + f] < _parameters.sieveSize) {
-				_addToSieveCache(factorsTable, sieveCache, sieveCachePos, factorsToEliminate[firstPrimeIndex*7 + f]);
-				factorsToEliminate[firstPrimeIndex*7 + f] += _primes32[firstPrimeIndex];
+			while (factorsToEliminate[firstPrimeIndex*_factorsStride + f] < blockEnd) {
+				_addToSieveCache(factorsTable, sieveCache, sieveCachePos, factorsToEliminate[firstPrimeIndex*_factorsStride + f]);
+				factorsToEliminate[firstPrimeIndex*_factorsStride + f] += _primes32[firstPrimeIndex];
 			}
-			factorsToEliminate[firstPrimeIndex*7 + f] -= _parameters.sieveSize;
+			factorsToEliminate[firstPrimeIndex*_factorsStride + f] -= iterationShift;
 		}
 		firstPrimeIndex++;
 	}
 
-	ymmreg_t offsetmax;
-	offsetmax.m256 = _mm256_set1_epi32(_parameters.sieveSize);
-	ymmreg_t storemask;
-	storemask.m256 = _mm256_set1_epi32(0xffffffff);
-	storemask.v[0] = 0;
+	ymmreg_t offsetmax, nextIteration;
+	offsetmax.m256 = _mm256_set1_epi32(blockEnd);
+	nextIteration.m256 = _mm256_set1_epi32(iterationShift);
+	ymmreg_t storemask1, storemask2; // The last lane of factor1 and the first of factor2 do not belong to their prime
+	storemask1.m256 = _mm256_set1_epi32(0xffffffff);
+	storemask1.v[7] = 0;
+	storemask2.m256 = _mm256_set1_epi32(0xffffffff);
+	storemask2.v[0] = 0;
 	for (uint64_t i(firstPrimeIndex) ; i < lastPrimeIndex ; i += 2) {
 		ymmreg_t p1, p2;
 		ymmreg_t factor1, factor2, nextIncr1, nextIncr2;
 		ymmreg_t cmpres1, cmpres2;
 		p1.m256 = _mm256_set1_epi32(_primes32[i]);
 		p2.m256 = _mm256_set1_epi32(_primes32[i + 1]);
-		factor1.m256 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&factorsToEliminate[i*7 + 0]));
-		factor2.m256 = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(&factorsToEliminate[i*7 + 6]));
+		// The other lanes can belong to another Sieve Worker with the interleaved layout, so they are not read and set to the block end to not extend the loop
+		factor1.m256 = _mm256_blendv_epi8(offsetmax.m256, _mm256_maskload_epi32(reinterpret_cast<int const*>(&factorsToEliminate[i*_factorsStride]), storemask1.m256), storemask1.m256);
+		factor2.m256 = _mm256_blendv_epi8(offsetmax.m256, _mm256_maskload_epi32(reinterpret_cast<int const*>(&factorsToEliminate[(i + 1)*_factorsStride - 1]), storemask2.m256), storemask2.m256);
 		while (true) {
 			cmpres1.m256 = _mm256_cmpgt_epi32(offsetmax.m256, factor1.m256);
 			cmpres2.m256 = _mm256_cmpgt_epi32(offsetmax.m256, factor2.m256);
@@ -760,10 +1834,10 @@ void Miner::_processSieve7_avx2(uint64_t *factorsTable, uint32_t* factorsToElimi
 			factor1.m256 = _mm256_add_epi32(factor1.m256, nextIncr1.m256);
 			factor2.m256 = _mm256_add_epi32(factor2.m256, nextIncr2.m256);
 		}
-		factor1.m256 = _mm256_sub_epi32(factor1.m256, offsetmax.m256);
-		factor2.m256 = _mm256_sub_epi32(factor2.m256, offsetmax.m256);
-		_mm256_storeu_si256(reinterpret_cast<__m256i*>(&factorsToEliminate[i*7 + 0]), factor1.m256);
-		_mm256_maskstore_epi32(reinterpret_cast<int*>(&factorsToEliminate[i*7 + 6]), storemask.m256, factor2.m256);
+		factor1.m256 = _mm256_sub_epi32(factor1.m256, nextIteration.m256);
+		factor2.m256 = _mm256_sub_epi32(factor2.m256, nextIteration.m256);
+		_mm256_maskstore_epi32(reinterpret_cast<int*>(&factorsToEliminate[i*_factorsStride]), storemask1.m256, factor1.m256);
+		_mm256_maskstore_epi32(reinterpret_cast<int*>(&factorsToEliminate[(i + 1)*_factorsStride - 1]), storemask2.m256, factor2.m256);
 	}
 	_endSieveCache(factorsTable, sieveCache);
 #else
@@ -772,19 +1846,21 @@ void Miner::_processSieve7_avx2(uint64_t *factorsTable, uint32_t* factorsToElimi
 #endif
 }
 
-void Miner::_processSieve8(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex) { // Assembly optimized sieving for 8-tuples by Michael Bell
+void Miner::_processSieve8(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, const uint32_t blockEnd) { // Assembly optimized sieving for 8-tuples by Michael Bell
 	assert(_parameters.pattern.size() == 8);
+	const uint32_t iterationShift(blockEnd == _parameters.sieveSize ? _parameters.sieveSize : 0);
 	std::array<uint32_t, sieveCacheSize> sieveCache{0};
 	uint64_t sieveCachePos(0);
-	xmmreg_t offsetmax;
-	offsetmax.m128 = _mm_set1_epi32(_parameters.sieveSize);
+	xmmreg_t offsetmax, nextIteration;
+	offsetmax.m128 = _mm_set1_epi32(blockEnd);
+	nextIteration.m128 = _mm_set1_epi32(iterationShift);
 	for (uint64_t i(firstPrimeIndex) ; i < lastPrimeIndex ; i += 1) {
 		xmmreg_t p1;
 		xmmreg_t factor1, factor2, nextIncr1, nextIncr2;
 		xmmreg_t cmpres1, cmpres2;
 		p1.m128 = _mm_set1_epi32(_primes32[i]);
-		factor1.m128 = _mm_load_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*8 + 0]));
-		factor2.m128 = _mm_load_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*8 + 4]));
+		factor1.m128 = _mm_load_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*_factorsStride + 0]));
+		factor2.m128 = _mm_load_si128(reinterpret_cast<__m128i const*>(&factorsToEliminate[i*_factorsStride + 4]));
 		while (true) {
 			cmpres1.m128 = _mm_cmpgt_epi32(offsetmax.m128, factor1.m128);
 			cmpres2.m128 = _mm_cmpgt_epi32(offsetmax.m128, factor2.m128);
@@ -804,18 +1880,19 @@ void Miner::_processSieve8(uint64_t *factorsTable, uint32_t* factorsToEliminate,
 			factor1.m128 = _mm_add_epi32(factor1.m128, nextIncr1.m128);
 			factor2.m128 = _mm_add_epi32(factor2.m128, nextIncr2.m128);
 		}
-		factor1.m128 = _mm_sub_epi32(factor1.m128, offsetmax.m128);
-		factor2.m128 = _mm_sub_epi32(factor2.m128, offsetmax.m128);
-		_mm_store_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*8 + 0]), factor1.m128);
-		_mm_store_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*8 + 4]), factor2.m128);
+		factor1.m128 = _mm_sub_epi32(factor1.m128, nextIteration.m128);
+		factor2.m128 = _mm_sub_epi32(factor2.m128, nextIteration.m128);
+		_mm_store_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*_factorsStride + 0]), factor1.m128);
+		_mm_store_si128(reinterpret_cast<__m128i*>(&factorsToEliminate[i*_factorsStride + 4]), factor2.m128);
 	}
 	_endSieveCache(factorsTable, sieveCache);
 }
 
-void Miner::_processSieve8_avx2(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex) { // Assembly optimized sieving for 8-tuples by Michael Bell
+void Miner::_processSieve8_avx2(uint64_t *factorsTable, uint32_t* factorsToEliminate, uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, const uint32_t blockEnd) { // Assembly optimized sieving for 8-tuples by Michael Bell
 	assert(_parameters.pattern.size() == 8);
 
 #ifdef __AVX2__
+	const uint32_t iterationShift(blockEnd == _parameters.sieveSize ? _parameters.sieveSize : 0);
 	std::array<uint32_t, sieveCacheSize> sieveCache{0};
 	uint64_t sieveCachePos(0);
 
@@ -823,25 +1900,26 @@ void Miner::_processSieve8_avx2(uint64_t *factorsTable, uint32_t* factorsToElimi
 	// Already eliminate for the first prime to sieve if it is odd to align for the optimizations
 	if ((firstPrimeIndex & 1) != 0) {
 		for (uint64_t f(0) ; f < 8 ; f++) {
-			while (factorsToEliminate[firstPrimeIndex*8 + f] < _parameters.sieveSize) {
-				_addToSieveCache(factorsTable, sieveCache, sieveCachePos, factorsToEliminate[firstPrimeIndex*8 + f]);
-				factorsToEliminate[firstPrimeIndex*8 + f] += _primes32[firstPrimeIndex];
+			while (factorsToEliminate[firstPrimeIndex*_factorsStride + f] < blockEnd) {
+				_addToSieveCache(factorsTable, sieveCache, sieveCachePos, factorsToEliminate[firstPrimeIndex*_factorsStride + f]);
+				factorsToEliminate[firstPrimeIndex*_factorsStride + f] += _primes32[firstPrimeIndex];
 			}
-			factorsToEliminate[firstPrimeIndex*8 + f] -= _parameters.sieveSize;
+			factorsToEliminate[firstPrimeIndex*_factorsStride + f] -= iterationShift;
 		}
 		firstPrimeIndex++;
 	}
 
-	ymmreg_t offsetmax;
-	offsetmax.m256 = _mm256_set1_epi32(_parameters.sieveSize);
+	ymmreg_t offsetmax, nextIteration;
+	offsetmax.m256 = _mm256_set1_epi32(blockEnd);
+	nextIteration.m256 = _mm256_set1_epi32(iterationShift);
 	for (uint64_t i(firstPrimeIndex) ; i < lastPrimeIndex ; i += 2) {
 		ymmreg_t p1, p2;
 		ymmreg_t factor1, factor2, nextIncr1, nextIncr2;
 		ymmreg_t cmpres1, cmpres2;
 		p1.m256 = _mm256_set1_epi32(_primes32[i]);
 		p2.m256 = _mm256_set1_epi32(_primes32[i + 1]);
-		factor1.m256 = _mm256_load_si256(reinterpret_cast<__m256i const*>(&factorsToEliminate[i*8 + 0]));
-		factor2.m256 = _mm256_load_si256(reinterpret_cast<__m256i const*>(&factorsToEliminate[i*8 + 8]));
+		factor1.m256 = _mm256_load_si256(reinterpret_cast<__m256i const*>(&factorsToEliminate[i*_factorsStride]));
+		factor2.m256 = _mm256_load_si256(reinterpret_cast<__m256i const*>(&factorsToEliminate[(i + 1)*_factorsStride]));
 		while (true) {
 			cmpres1.m256 = _mm256_cmpgt_epi32(offsetmax.m256, factor1.m256);
 			cmpres2.m256 = _mm256_cmpgt_epi32(offsetmax.m256, factor2.m256);
@@ -869,10 +1947,10 @@ void Miner::_processSieve8_avx2(uint64_t *factorsTable, uint32_t* factorsToElimi
 			factor1.m256 = _mm256_add_epi32(factor1.m256, nextIncr1.m256);
 			factor2.m256 = _mm256_add_epi32(factor2.m256, nextIncr2.m256);
 		}
-		factor1.m256 = _mm256_sub_epi32(factor1.m256, offsetmax.m256);
-		factor2.m256 = _mm256_sub_epi32(factor2.m256, offsetmax.m256);
-		_mm256_store_si256(reinterpret_cast<__m256i*>(&factorsToEliminate[i*8 + 0]), factor1.m256);
-		_mm256_store_si256(reinterpret_cast<__m256i*>(&factorsToEliminate[i*8 + 8]), factor2.m256);
+		factor1.m256 = _mm256_sub_epi32(factor1.m256, nextIteration.m256);
+		factor2.m256 = _mm256_sub_epi32(factor2.m256, nextIteration.m256);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&factorsToEliminate[i*_factorsStride]), factor1.m256);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&factorsToEliminate[(i + 1)*_factorsStride]), factor2.m256);
 	}
 	_endSieveCache(factorsTable, sieveCache);
 #else
@@ -888,27 +1966,35 @@ void Miner::_doSieveTask(Task task) {
 	std::array<uint32_t, sieveCacheSize> sieveCache{0};
 	uint64_t sieveCachePos(0);
 	Task checkTask{Task::Type::Check, workIndex, {}};
+	const auto processSieve([&](const uint64_t firstPrimeIndex, const uint64_t lastPrimeIndex, const uint32_t blockEnd) {
+		if (firstPrimeIndex >= lastPrimeIndex)
+			return;
+		if (_parameters.pattern.size() == 6)
+			_processSieve6(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, lastPrimeIndex, blockEnd);
+		else if (_parameters.pattern.size() == 7)
+			if (_parameters.useAvx2)
+				_processSieve7_avx2(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, lastPrimeIndex, blockEnd);
+			else
+				_processSieve7(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, lastPrimeIndex, blockEnd);
+		else if (_parameters.pattern.size() == 8)
+			if (_parameters.useAvx2)
+				_processSieve8_avx2(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, lastPrimeIndex, blockEnd);
+			else
+				_processSieve8(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, lastPrimeIndex, blockEnd);
+		else
+			_processSieve(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, lastPrimeIndex, blockEnd);
+	});
 	
 	if (_works[workIndex].job.height != _client->currentHeight()) // Abort Sieve Task if new block (but count as Task done)
 		goto sieveEnd;
 	
 	memset(sieve.factorsTable, 0, sizeof(uint64_t)*_parameters.sieveWords);
 	
-	// Eliminate the p*i + fp factors (p < factorMax).
-	if (_parameters.pattern.size() == 6)
-		_processSieve6(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, _primesIndexThreshold);
-	else if (_parameters.pattern.size() == 7)
-		if (_parameters.useAvx2)
-			_processSieve7_avx2(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, _primesIndexThreshold);
-		else
-			_processSieve7(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, _primesIndexThreshold);
-	else if (_parameters.pattern.size() == 8)
-		if (_parameters.useAvx2)
-			_processSieve8_avx2(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, _primesIndexThreshold);
-		else
-			_processSieve8(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, _primesIndexThreshold);
-	else
-		_processSieve(sieve.factorsTable, sieve.factorsToEliminate, firstPrimeIndex, _primesIndexThreshold);
+	// Eliminate the p*i + fp factors (p < factorMax), block by block for the small primes that have factors in every part of the factorsTable.
+	for (uint64_t blockEnd(std::min(sieveBlockSize, _parameters.sieveSize)) ; blockEnd < _parameters.sieveSize ; blockEnd += sieveBlockSize)
+		processSieve(firstPrimeIndex, std::min(_blockSievedPrimesIndex, _primesIndexThreshold), blockEnd);
+	processSieve(firstPrimeIndex, std::min(_blockSievedPrimesIndex, _primesIndexThreshold), _parameters.sieveSize);
+	processSieve(std::min(_blockSievedPrimesIndex, _primesIndexThreshold), _primesIndexThreshold, _parameters.sieveSize);
 	
 	if (_works[workIndex].job.height != _client->currentHeight())
 		goto sieveEnd;
@@ -917,8 +2003,13 @@ void Miner::_doSieveTask(Task task) {
 	if (sieveIteration == 0) presieveLock.lock();
 	
 	// Eliminate these factors.
-	for (uint64_t i(0), count(sieve.additionalFactorsToEliminateCounts[sieveIteration]); i < count ; i++)
-		_addToSieveCache(sieve.factorsTable, sieveCache, sieveCachePos, sieve.additionalFactorsToEliminate[sieveIteration][i]);
+	for (uint64_t bucket(0), bucketsPerIteration(_factorsBuckets/_parameters.sieveIterations) ; bucket < bucketsPerIteration ; bucket++) { // In the order of the factorsTable
+		const uint32_t bucketStart(bucket << _factorsBucketBits);
+		for (const FactorsChunk *chunk(sieve.additionalFactorsChunks[sieveIteration*bucketsPerIteration + bucket]) ; chunk != nullptr ; chunk = chunk->next) {
+			for (uint32_t i(0), count(std::min(chunk->count.load(), factorsChunkEntries)) ; i < count ; i++) // The count can exceed the chunk's capacity
+				_addToSieveCache(sieve.factorsTable, sieveCache, sieveCachePos, bucketStart + chunk->factors[i]);
+		}
+	}
 	_endSieveCache(sieve.factorsTable, sieveCache);
 	
 	if (_works[workIndex].job.height != _client->currentHeight())
@@ -926,7 +2017,7 @@ void Miner::_doSieveTask(Task task) {
 	
 	checkTask.check.nCandidates = 0;
 	checkTask.check.offsetId = sieve.id;
-	checkTask.check.factorStart = sieveIteration*_parameters.sieveSize;
+	checkTask.check.factorStart = _works[workIndex].factorStart + sieveIteration*_parameters.sieveSize;
 	// Extract candidates from the sieve and create verify tasks of up to maxCandidatesPerCheckTask candidates.
 	for (uint32_t b(0) ; b < _parameters.sieveWords ; b++) {
 		uint64_t sieveWord(~sieve.factorsTable[b]); // ~ is the Bitwise Not: ones then indicate the candidates and zeros the previously eliminated numbers.
@@ -993,7 +2084,7 @@ void Miner::_doCheckTask(Task task) {
 	if (_works[workIndex].job.height != _client->currentHeight()) return;
 	std::vector<uint64_t> tupleCounts(_parameters.pattern.size() + 1, 0);
 	mpz_class candidateStart, candidate;
-	mpz_mul_ui(candidateStart.get_mpz_t(), _primorial.get_mpz_t(), task.check.factorStart);
+	candidateStart = _primorial*u64ToMpz(task.check.factorStart);
 	candidateStart += _works[workIndex].primorialMultipleStart;
 	candidateStart += _primorialOffsets[task.check.offsetId];
 	
@@ -1066,26 +2157,39 @@ void Miner::_doCheckTask(Task task) {
 void Miner::_doTasks(const uint16_t id) { // Worker Threads run here until the miner is stopped
 	// Thread initialization.
 	threadId = id;
-	factorsCache = new uint64_t*[_parameters.sieveWorkers];
-	factorsCacheCounts = new uint64_t*[_parameters.sieveWorkers];
-	for (int i(0) ; i < _parameters.sieveWorkers ; i++) {
-		factorsCache[i] = new uint64_t[factorsCacheSize];
-		factorsCacheCounts[i] = new uint64_t[_parameters.sieveIterations];
-		for (uint64_t j(0) ; j < _parameters.sieveIterations ; j++)
-			factorsCacheCounts[i][j] = 0;
+	if (factorsCacheSieveWorkers != _parameters.sieveWorkers || factorsCacheBuckets != _factorsBuckets) { // Else, the caches of the previous run are reused
+		for (int i(0) ; i < factorsCacheSieveWorkers ; i++)
+			delete[] factorsCache[i];
+		delete[] factorsCache;
+		delete[] factorsBucketsEnds;
+		delete[] factorsSorted;
+		factorsCache = new uint64_t*[_parameters.sieveWorkers];
+		for (int i(0) ; i < _parameters.sieveWorkers ; i++)
+			factorsCache[i] = new uint64_t[factorsCacheSize];
+		factorsBucketsEnds = new uint32_t[_factorsBuckets + 1];
+		factorsSorted = new uint16_t[factorsCacheSize];
+		factorsCacheSieveWorkers = _parameters.sieveWorkers;
+		factorsCacheBuckets = _factorsBuckets;
 	}
 	// Threads are fetching tasks from the queues. The first part of the constellation search is sieving to generate candidates, which is done by the Presieve and Sieve tasks.
 	// Once the candidates were generated, they are tested whether they are indeed base primes of constellations using the Fermat Test.
 	while (_running) {
 		Task task;
-		if (!_presieveTasks.try_pop_front(task)) // Presieve Tasks have priority
+		if (_presieveTasks.try_pop_front(task)) { // Presieve Tasks have priority
+			Task stolenTask;
+			if (task.presieve.start >= _primesIndexThreshold && _stealPresieveTask(stolenTask, true)) { // Help to finish the primes below the threshold first, so the Sieve Tasks can start sooner
+				_presieveTasks.push_front(task);
+				task = stolenTask;
+			}
+		}
+		else if (!_stealPresieveTask(task, false)) // Else, help the threads still presieving
 			task = _tasks.blocking_pop_front();
 		
 		const auto startTime(std::chrono::steady_clock::now());
 		if (task.type == Task::Type::Presieve) {
 			_doPresieveTask(task);
 			_presieveTime += std::chrono::duration_cast<decltype(_presieveTime)>(std::chrono::steady_clock::now() - startTime);
-			_tasksDoneInfos.push_back(TaskDoneInfo{Task::Type::Presieve, {task.presieve.start}});
+			// The Presieve's Task Done Info is created in _doPresieveTask
 		}
 		if (task.type == Task::Type::Sieve) {
 			_doSieveTask(task);
@@ -1098,20 +2202,21 @@ void Miner::_doTasks(const uint16_t id) { // Worker Threads run here until the m
 			_tasksDoneInfos.push_back(TaskDoneInfo{Task::Type::Check, {task.workIndex}});
 		}
 	}
-	// Thread clean up.
-	for (int i(0) ; i < _parameters.sieveWorkers ; i++) {
-		delete factorsCacheCounts[i];
-		delete factorsCache[i];
-	}
-	delete factorsCacheCounts;
-	delete factorsCache;
 }
 
 void Miner::_manageTasks() {
 	Job job; // Block's data (target, blockheader if applicable, ...) from the Client
 	_currentWorkIndex = 0;
 	uint32_t oldHeight(0);
-	while (_running && _client->getJob(job)) {
+	uint64_t factorStart(0);
+	bool extendJob(false); // If true, the previous job is continued with the next window of primorial factors instead of getting a new one
+	while (_running && (extendJob || _client->getJob(job))) {
+		bool carryFactors(extendJob); // The factors of the primes below the threshold are then already at the new window after the last Sieve Iteration
+		factorStart = extendJob ? factorStart + _factorMax : 0;
+		if (_pendingPrimeDataReady) { // Progressive startup, the previous Presieve and Sieve Tasks are all done here and the Check Tasks do not use the prime table
+			_swapInPendingPrimeData();
+			carryFactors = false;
+		}
 		if (job.difficulty < _difficultyAtInit/_parameters.restartDifficultyFactor || job.difficulty > _difficultyAtInit*_parameters.restartDifficultyFactor) { // Restart to retune parameters.
 			_keepStats = true;
 			_shouldRestart = true;
@@ -1139,29 +2244,85 @@ void Miner::_manageTasks() {
 			std::cout << " Block " << job.height << ", average " << FIXED(1) << _statManager.averageBlockTime() << " s, difficulty " << FIXED(3) << job.difficulty << std::endl;
 		}
 		_works[_currentWorkIndex].primorialMultipleStart = _works[_currentWorkIndex].job.target + _primorial - (_works[_currentWorkIndex].job.target % _primorial);
-		// Reset Counts and create Presieve Tasks
+		_works[_currentWorkIndex].factorStart = factorStart;
+		_presieveDelta = 0;
+		_additionalPresieveDelta = 0;
+		if (_deltaPresieve) { // The previous factors can be updated if the new window starts less than 2^64 primorials after the previous one
+			const mpz_class windowStart(_works[_currentWorkIndex].primorialMultipleStart + _primorial*u64ToMpz(factorStart));
+			uint64_t delta(0);
+			if (_previousFactorsValid && windowStart > _previousPrimorialMultipleStart) {
+				const mpz_class deltaMpz((windowStart - _previousPrimorialMultipleStart)/_primorial);
+				if (mpz_sizeinbase(deltaMpz.get_mpz_t(), 2) <= 64)
+					delta = mpzToU64(deltaMpz);
+			}
+			if (delta == 0) carryFactors = false; // The carried factors could not be related to the stored ones anymore
+			if (delta > _previousAdditionalFactorsOffset)
+				_additionalPresieveDelta = delta - _previousAdditionalFactorsOffset;
+			if (carryFactors)
+				_previousAdditionalFactorsOffset = delta;
+			else {
+				_presieveDelta = delta;
+				_previousPrimorialMultipleStart = windowStart;
+				_previousAdditionalFactorsOffset = 0;
+			}
+			_previousFactorsValid = true;
+		}
+		// Reset the additional factors and create Presieve Tasks, only for the primes above the threshold if the factors of the ones below are carried over
+		_additionalFactorsArena.reset();
 		for (auto &sieve : _sieves) {
-			for (uint64_t j(0) ; j < _parameters.sieveIterations ; j++)
-				sieve.additionalFactorsToEliminateCounts[j] = 0;
+			for (uint64_t j(0) ; j < _factorsBuckets ; j++)
+				sieve.additionalFactorsChunks[j] = nullptr;
 		}
-		uint64_t nPresieveTasks(_parameters.threads*8ULL);
-		int32_t nRemainingNormalPresieveTasks(0), nRemainingAdditionalPresieveTasks(0);
+		// The Presieve Tasks have about the same estimated cost, using the measured cost per prime of the three parts of the prime table, which they do not cross. The idle threads can still steal the end of the slow ones.
+		// Their Task Done Infos give the primes that were presieved, which are counted instead of the Tasks.
+		const uint64_t nPresieveTasks(_parameters.threads*8ULL);
 		const uint32_t remainingTasks(_tasks.size());
-		const uint64_t primesPerPresieveTask((_nPrimes - _parameters.primorialNumber)/nPresieveTasks + 1ULL);
-		for (uint64_t start(_parameters.primorialNumber) ; start < _nPrimes ; start += primesPerPresieveTask) {
-			const uint64_t end(std::min(_nPrimes, start + primesPerPresieveTask));
-			_presieveTasks.push_back(Task::PresieveTask(_currentWorkIndex, start, end));
-			_tasks.push_front(Task{Task::Type::Dummy, _currentWorkIndex, {}}); // To ensure a thread wakes up to grab the mod work.
-			if (start < _primesIndexThreshold) nRemainingNormalPresieveTasks++;
-			else nRemainingAdditionalPresieveTasks++;
+		const uint64_t firstPresievedPrimeIndex(carryFactors ? _primesIndexThreshold : _parameters.primorialNumber);
+		const std::array<uint64_t, 4> partsBounds{firstPresievedPrimeIndex, _primesIndexThreshold, std::max(_primesIndexThreshold, _nPrimes32), _nPrimes};
+		// For every part presieved from scratch, the remainder tree is tried once the cost without it is known, then the fastest method is used. The costs are measured again after a candidate size change.
+		const uint64_t candidateLimbs(mpz_size(_works[_currentWorkIndex].primorialMultipleStart.get_mpz_t()));
+		if (candidateLimbs != _scratchPresieveLimbs) {
+			_scratchPresieveCostPerPrime = {};
+			_scratchPresieveLimbs = candidateLimbs;
+		}
+		const std::array<bool, 3> fromScratch{_presieveDelta == 0, _additionalPresieveDelta == 0, _additionalPresieveDelta == 0};
+		for (uint64_t part(0) ; part < 3 ; part++) {
+			const std::array<double, 2> &costs(_scratchPresieveCostPerPrime[part]);
+			_useRemainderTree[part] = fromScratch[part] && candidateLimbs >= remainderTreeMinLimbs && costs[0] > 0. && (costs[1] == 0. || costs[1] < costs[0]);
+		}
+		std::array<double, 3> partsCosts;
+		double costPerPrimeMean(0.), totalCost(0.);
+		uint64_t nMeasuredParts(0);
+		for (uint64_t part(0) ; part < 3 ; part++) {
+			if (_presieveCostPerPrime[part] > 0.) {
+				costPerPrimeMean += _presieveCostPerPrime[part];
+				nMeasuredParts++;
+			}
+		}
+		costPerPrimeMean = nMeasuredParts > 0 ? costPerPrimeMean/static_cast<double>(nMeasuredParts) : 1.;
+		for (uint64_t part(0) ; part < 3 ; part++) {
+			partsCosts[part] = static_cast<double>(partsBounds[part + 1] - std::min(partsBounds[part], partsBounds[part + 1]))*(_presieveCostPerPrime[part] > 0. ? _presieveCostPerPrime[part] : costPerPrimeMean);
+			totalCost += partsCosts[part];
+			_presieveCostNs[part] = 0;
+			_presievedPrimes[part] = 0;
+		}
+		uint64_t nRemainingNormalPresievePrimes(_primesIndexThreshold - firstPresievedPrimeIndex), nRemainingAdditionalPresievePrimes(_nPrimes - _primesIndexThreshold);
+		for (uint64_t part(0) ; part < 3 ; part++) {
+			if (partsBounds[part] >= partsBounds[part + 1]) continue;
+			const uint64_t nPartTasks(std::max(static_cast<uint64_t>(std::llround(static_cast<double>(nPresieveTasks)*partsCosts[part]/totalCost)), static_cast<uint64_t>(1)));
+			const uint64_t primesPerPresieveTask(std::min((partsBounds[part + 1] - partsBounds[part])/nPartTasks + 1, static_cast<uint64_t>(std::numeric_limits<uint32_t>::max())));
+			for (uint64_t start(partsBounds[part]) ; start < partsBounds[part + 1] ; start += primesPerPresieveTask) {
+				_presieveTasks.push_back(Task::PresieveTask(_currentWorkIndex, start, std::min(partsBounds[part + 1], start + primesPerPresieveTask)));
+				_tasks.push_front(Task{Task::Type::Dummy, _currentWorkIndex, {}}); // To ensure a thread wakes up to grab the mod work.
+			}
 		}
 		
-		while (nRemainingNormalPresieveTasks > 0) {
+		while (nRemainingNormalPresievePrimes > 0) {
 			const TaskDoneInfo taskDoneInfo(_tasksDoneInfos.blocking_pop_front());
 			if (!_running) return; // Can happen if stopThreads is called while this Thread is stuck in this blocking_pop_front().
 			if (taskDoneInfo.type == Task::Type::Presieve) {
-				if (taskDoneInfo.firstPrimeIndex < _primesIndexThreshold) nRemainingNormalPresieveTasks--;
-				else nRemainingAdditionalPresieveTasks--;
+				if (taskDoneInfo.presieve.start < _primesIndexThreshold) nRemainingNormalPresievePrimes -= taskDoneInfo.presieve.end - taskDoneInfo.presieve.start;
+				else nRemainingAdditionalPresievePrimes -= taskDoneInfo.presieve.end - taskDoneInfo.presieve.start;
 			}
 			else if (taskDoneInfo.type == Task::Type::Check) _works[taskDoneInfo.workIndex].nRemainingCheckTasks--;
 			else ERRORMSG("Unexpected Sieve Task done during Presieving");
@@ -1175,14 +2336,27 @@ void Miner::_manageTasks() {
 		}
 		
 		int nRemainingSieves(_parameters.sieveWorkers);
-		while (nRemainingAdditionalPresieveTasks > 0) {
+		while (nRemainingAdditionalPresievePrimes > 0) {
 			const TaskDoneInfo taskDoneInfo(_tasksDoneInfos.blocking_pop_front());
-			if (!_running) return;
-			if (taskDoneInfo.type == Task::Type::Presieve) nRemainingAdditionalPresieveTasks--;
+			if (!_running) { // The Sieve Tasks waiting for the additional factors must not stay blocked
+				for (auto &sieve : _sieves) sieve.presieveLock.unlock();
+				return;
+			}
+			if (taskDoneInfo.type == Task::Type::Presieve) nRemainingAdditionalPresievePrimes -= taskDoneInfo.presieve.end - taskDoneInfo.presieve.start;
 			else if (taskDoneInfo.type == Task::Type::Sieve) nRemainingSieves--;
 			else _works[taskDoneInfo.workIndex].nRemainingCheckTasks--;
 		}
 		for (auto &sieve : _sieves) sieve.presieveLock.unlock();
+		for (uint64_t part(0) ; part < 3 ; part++) { // Update the cost estimations, smoothed as they depend on whether the presieve was done from scratch
+			if (_presievedPrimes[part] > 0) {
+				const double costPerPrime(static_cast<double>(_presieveCostNs[part])/static_cast<double>(_presievedPrimes[part]));
+				_presieveCostPerPrime[part] = _presieveCostPerPrime[part] > 0. ? (_presieveCostPerPrime[part] + costPerPrime)/2. : costPerPrime;
+				if (fromScratch[part]) {
+					double &scratchCostPerPrime(_scratchPresieveCostPerPrime[part][_useRemainderTree[part]]);
+					scratchCostPerPrime = scratchCostPerPrime > 0. ? (scratchCostPerPrime + costPerPrime)/2. : costPerPrime;
+				}
+			}
+		}
 		
 		uint32_t nRemainingTasksMin(std::min(remainingTasks, _tasks.size()));
 		while (nRemainingSieves > 0) {
@@ -1223,6 +2397,7 @@ void Miner::_manageTasks() {
 		}
 		
 		oldHeight = _works[_currentWorkIndex].job.height;
+		extendJob = _extendJobs && factorStart/_factorMax + 1 < _factorWindows && !_shouldRestart && _works[_currentWorkIndex].job.height == _client->currentHeight();
 		
 		while (_works[_currentWorkIndex].nRemainingCheckTasks > _nRemainingCheckTasksThreshold) {
 			const TaskDoneInfo taskDoneInfo(_tasksDoneInfos.blocking_pop_front());
@@ -5,6 +5,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <mutex>
 #include <immintrin.h>
 #include "Stats.hpp"
 #include "Client.hpp"
@@ -27,12 +28,6 @@ union ymmreg_t {
 constexpr uint32_t sieveCacheSize(32);
 constexpr uint32_t nWorks(2);
 
-inline mpz_class u64ToMpz(const uint64_t u64) {
-	mpz_class mpz;
-	mpz_import(mpz.get_mpz_t(), 1, 1, 8, 0, 0, &u64);
-	return mpz;
-}
-
 inline std::vector<mpz_class> v64ToVMpz(const std::vector<uint64_t> &v64) {
 	std::vector<mpz_class> vMpz;
 	for (const auto & n : v64)
@@ -58,7 +53,7 @@ struct Task {
 		struct {
 			uint32_t offsetId;
 			uint32_t nCandidates;
-			uint32_t factorStart; // The form of a candidate is firstCandidate + primorial*f, with f = factorStart + factorOffset
+			uint64_t factorStart; // The form of a candidate is firstCandidate + primorial*f, with f = factorStart + factorOffset
 			std::array<uint32_t, maxCandidatesPerCheckTask> factorOffsets;
 		} check;
 	};
@@ -85,27 +80,118 @@ struct TaskDoneInfo {
 	Task::Type type;
 	union {
 		uint64_t workIndex;
-		uint64_t firstPrimeIndex;
+		struct {
+			uint64_t start;
+			uint64_t end;
+		} presieve; // The primes actually presieved by the Task, as an idle thread may have stolen the end of its range
 	};
+
+	static TaskDoneInfo PresieveTaskDoneInfo(uint64_t start, uint64_t end) {
+		TaskDoneInfo taskDoneInfo;
+		taskDoneInfo.type = Task::Type::Presieve;
+		taskDoneInfo.presieve.start = start;
+		taskDoneInfo.presieve.end = end;
+		return taskDoneInfo;
+	}
+};
+
+// Range of a Presieve Task being done by a Worker Thread, which claims its primes by slices so an idle thread can steal the end
+struct PresieveRange {
+	std::atomic<uint64_t> bounds{0}; // Next and end prime indexes relative to the start, in the low and high 32 bits
+	uint64_t workIndex = 0, start = 0;
+	bool active = false; // Only read and written with the Miner's presieve ranges mutex
 };
 
 struct MinerWork {
 	Job job; // Fetched from the Client, to be completed with the solution once it is found.
 	mpz_class primorialMultipleStart; // First multiple of the primorial after the target.
+	uint64_t factorStart = 0; // First primorial factor of the window being sieved, a multiple of factorMax when the job is extended
 	std::atomic<uint64_t> nRemainingCheckTasks{0};
 	void clear() {
 		primorialMultipleStart = 0;
+		factorStart = 0;
 		nRemainingCheckTasks = 0;
 	}
 };
 
+// Block of additional factors of a bucket, shared by the presieve threads that reserve entries in it, and linked to the bucket's list
+constexpr uint64_t factorsBucketBits(16); // The additional factors are sorted in buckets of 2^16 entries of the factorsTable and stored as 16 bits offsets in them
+constexpr uint32_t factorsChunkEntries(1018); // So a chunk takes 2 kB
+struct FactorsChunk {
+	FactorsChunk *next;
+	std::atomic<uint32_t> count; // Of reserved entries, can exceed factorsChunkEntries once the chunk is full
+	uint16_t factors[factorsChunkEntries];
+};
+
+// Pool of Factors Chunks, claimed with a single atomic increment. The pages of chunks are allocated when first needed and kept for the next jobs, so the memory use follows the actual number of additional factors.
+class FactorsArena {
+	static constexpr uint64_t _chunksPerPage = 512, _maxPages = 65536;
+	std::unique_ptr<std::atomic<FactorsChunk*>[]> _pages;
+	std::atomic<uint64_t> _nextChunk, _allocatedPages;
+	std::mutex _pagesMutex;
+public:
+	FactorsArena() : _pages(std::make_unique<std::atomic<FactorsChunk*>[]>(_maxPages)), _nextChunk(0), _allocatedPages(0) {
+		for (uint64_t i(0) ; i < _maxPages ; i++) _pages[i] = nullptr;
+	}
+	~FactorsArena() {clear();}
+	FactorsChunk* claim() { // Returns nullptr if no more memory can be allocated
+		const uint64_t index(_nextChunk++), page(index/_chunksPerPage);
+		if (page >= _maxPages) return nullptr;
+		FactorsChunk *chunks(_pages[page]);
+		if (chunks == nullptr) {
+			std::lock_guard<std::mutex> lock(_pagesMutex);
+			chunks = _pages[page];
+			if (chunks == nullptr) {
+				try {chunks = new FactorsChunk[_chunksPerPage];}
+				catch (std::bad_alloc& ba) {return nullptr;}
+				_pages[page] = chunks;
+				_allocatedPages++;
+			}
+		}
+		return &chunks[index % _chunksPerPage];
+	}
+	void reset() {_nextChunk = 0;} // Must only be called when no chunk is in use
+	void clear() {
+		reset();
+		for (uint64_t i(0) ; i < _maxPages ; i++) {
+			delete[] _pages[i];
+			_pages[i] = nullptr;
+		}
+		_allocatedPages = 0;
+	}
+	uint64_t bytes() const {return _allocatedPages*_chunksPerPage*sizeof(FactorsChunk);}
+};
+
 struct Sieve {
 	uint32_t id;
 	std::mutex presieveLock;
 	uint64_t *factorsTable = nullptr; // Booleans corresponding to whether a primorial factor is eliminated
 	uint32_t *factorsToEliminate = nullptr; // One entry for each constellation offset, for each prime number p < factorMax (the factors are in the form of indexes of the factorsTable)
-	uint32_t **additionalFactorsToEliminate = nullptr; // Factors for p >= factorMax (they are eliminated only once and treated separately), arranged by Sieve Iteration (also in the form of indexes of the factorsTable)
-	std::atomic<uint64_t> *additionalFactorsToEliminateCounts = nullptr; // Counts for each Sieve Iteration
+	std::atomic<FactorsChunk*> *additionalFactorsChunks = nullptr; // Factors for p >= factorMax (they are eliminated only once and treated separately), as lists of chunks for each bucket of each Sieve Iteration (in the form of offsets in the bucket)
+};
+
+// Prime table and the data depending on it, prepared in the background during a progressive startup and then swapped with the Miner's current one.
+struct PendingPrimeData {
+	Table<uint32_t> primes32, modularInverses32;
+	Table<uint64_t> primes64, modularInverses64, modPrecompute;
+	CompactPrimeTable compactPrimes;
+	uint64_t nPrimes = 0, nPrimes32 = 0, primesIndexThreshold = 0;
+	std::vector<uint32_t*> factorsToEliminate; // For every Sieve, or a single one shared by all of them with the interleaved layout
+	~PendingPrimeData() {
+		for (auto &factors : factorsToEliminate)
+			delete[] reinterpret_cast<__m256i*>(factors);
+	}
+};
+
+// Data of the previous initialization kept by a retune, and reused by the next one if still valid for the new parameters.
+struct RetainedData {
+	uint64_t primeTableLimit = 0, primorialNumber = 0, sieveWords = 0, sieveIterations = 0, factorsToEliminateEntries = 0;
+	bool interleavedFactors = false;
+	Table<uint32_t> primes32, modularInverses32;
+	Table<uint64_t> primes64, modularInverses64, modPrecompute;
+	CompactPrimeTable compactPrimes;
+	std::vector<Sieve> sieves;
+	~RetainedData(); // Frees the Sieves' allocations that were not reused
 };
 
 class Miner {
@@ -113,22 +199,63 @@ class Miner {
 	MinerParameters _parameters;
 	std::shared_ptr<Client> _client;
 	StatManager _statManager;
+	// The threads are kept between runs, parked until the next startThreads()
 	std::thread _masterThread;
 	std::vector<std::thread> _workerThreads;
+	std::mutex _threadsMutex;
+	std::condition_variable _threadsCondition;
+	uint64_t _threadsRun; // Incremented by startThreads() to wake up the parked threads
+	bool _masterThreadActive, _threadsShouldExit;
+	uint16_t _activeWorkerThreads;
 	CpuID _cpuInfo;
 	// Miner data (generated in init)
 	mpz_class _primorial;
 	uint64_t _nPrimes, _nPrimes32, _factorMax, _primesIndexThreshold;
-	std::vector<uint32_t> _primes32, _modularInverses32;
-	std::vector<uint64_t> _primes64, _modularInverses64, _modPrecompute;
+	uint64_t _blockSievedPrimesIndex; // The primes before are sieved by blocks of the factorsTable
+	bool _extendJobs;
+	uint64_t _factorWindows; // Number of windows of factorMax primorial factors fitting in the target's offset, the job can be extended to the next ones
+	uint64_t _factorsBucketBits, _factorsBuckets; // Size of the buckets of additional factors (less than 2^16 only for small Sieves) and their total number for all the Sieve Iterations
+	uint64_t _factorsStride; // Distance between the factorsToEliminate entries of consecutive primes, PatternLength*SieveWorkers with the interleaved layout where the Sieves' arrays are offsets in the first one's allocation
+	uint64_t _primeTableLimit; // Of the current prime table, which can be the small one of a progressive startup
+	Table<uint32_t> _primes32, _modularInverses32;
+	Table<uint64_t> _primes64, _modularInverses64, _modPrecompute;
+	CompactPrimeTable _compactPrimes; // If enabled, the primes from the threshold index, only used in the presieve, are stored here instead (then _nPrimes32 is still the number of primes < 2^32)
 	std::vector<mpz_class> _primorialOffsets;
 	std::vector<uint64_t> _halfPattern, _primorialOffsetDiff;
+	// Progressive startup, the full prime table is prepared by this thread while mining with a smaller one
+	std::thread _backgroundInitThread;
+	std::unique_ptr<PendingPrimeData> _pendingPrimeData;
+	std::atomic<bool> _pendingPrimeDataReady;
+	std::unique_ptr<RetainedData> _retainedData; // Set by a retune for the next initialization
+	// Job independent part of the initialization, done in the background while the client connects
+	std::thread _preloadThread;
+	std::unique_ptr<RetainedData> _preloadedData;
+	std::atomic<bool> _preloadedDataReady;
+	// Delta presieve (Benchmark and Search Modes): the first eliminated factors of the previous job for the first Sieve Worker, updated for the next one if its start is not too far
+	bool _deltaPresieve;
+	std::vector<uint32_t> _previousFactors32;
+	std::vector<uint64_t> _previousFactors64;
+	mpz_class _previousPrimorialMultipleStart; // Start of the window where the primes below the threshold were presieved
+	uint64_t _previousAdditionalFactorsOffset; // The factors of the primes above are for the start plus this number of primorials (carried over windows of an extended job)
+	uint64_t _presieveDelta, _additionalPresieveDelta; // Number of primorials from the previous starts, 0 if the presieve is done from scratch
+	std::atomic<bool> _previousFactorsValid; // Cleared if a presieve was interrupted
 	// Miner state variables
 	bool _inited, _running, _shouldRestart, _keepStats;
 	double _difficultyAtInit; // Restart the miner if the Difficulty changed a lot to retune
 	TsQueue<Task> _presieveTasks, _tasks;
+	// Presieve work stealing and cost estimations for the parts of the prime table (below the threshold, above with primes < 2^32, then the larger primes), used to size the Presieve Tasks and to choose the presieve method
+	std::unique_ptr<PresieveRange[]> _presieveRanges; // For every Worker Thread
+	std::mutex _presieveRangesMutex;
+	std::atomic<uint16_t> _activePresieveRanges;
+	std::array<double, 3> _presieveCostPerPrime;
+	std::array<std::atomic<uint64_t>, 3> _presieveCostNs, _presievedPrimes;
+	std::array<std::array<double, 2>, 3> _scratchPresieveCostPerPrime; // Without and with the remainder tree, when presieving from scratch candidates of _scratchPresieveLimbs limbs
+	uint64_t _scratchPresieveLimbs;
+	std::array<bool, 3> _useRemainderTree; // Set before creating the Presieve Tasks
 	TsQueue<TaskDoneInfo> _tasksDoneInfos;
 	std::vector<Sieve> _sieves;
+	FactorsArena _additionalFactorsArena;
+	std::atomic<bool> _additionalFactorsArenaFull; // To show the error only once
 	std::array<MinerWork, nWorks> _works; // Alternating work for better efficiency when there is a new block
 	uint32_t _nRemainingCheckTasksThreshold, _currentWorkIndex;
 	std::chrono::microseconds _presieveTime, _sieveTime, _verifyTime;
@@ -150,37 +277,59 @@ class Miner {
 		}
 	}
 	
-	void _addCachedAdditionalFactorsToEliminate(Sieve&, uint64_t*, uint64_t*, const int);
+	bool _loadPrimeTable(const uint64_t, Table<uint32_t>&, Table<uint64_t>&) const; // From the shared memory if enabled and available, else with the function below
+	bool _loadOrGeneratePrimeTable(const uint64_t, Table<uint32_t>&, Table<uint64_t>&) const;
+	bool _compactPrimeTable(const uint64_t, Table<uint32_t>&, Table<uint64_t>&, CompactPrimeTable&) const;
+	bool _reusePrimeTable(RetainedData&, Table<uint32_t>&, Table<uint64_t>&) const;
+	void _computePrimesIndexThreshold(const Table<uint32_t>&, const Table<uint64_t>&, uint64_t&, uint64_t&) const;
+	bool _precomputeModularInverses(const uint64_t, const Table<uint32_t>&, const Table<uint64_t>&, Table<uint32_t>&, Table<uint64_t>&, Table<uint64_t>&) const; // From the shared memory if enabled and available, else with the function below
+	bool _loadOrPrecomputeModularInverses(const uint64_t, const Table<uint32_t>&, const Table<uint64_t>&, Table<uint32_t>&, Table<uint64_t>&, Table<uint64_t>&) const;
+	void _computeModularInverses(const Table<uint32_t>&, const Table<uint64_t>&, Table<uint32_t>&, Table<uint64_t>&, Table<uint64_t>&, const bool) const; // The division data is also computed if the last argument is true
+	bool _loadPrecomputedData(const uint64_t, const Table<uint32_t>&, const Table<uint64_t>&, Table<uint32_t>&, Table<uint64_t>&, Table<uint64_t>&) const;
+	void _savePrecomputedData(const uint64_t, const Table<uint32_t>&, const Table<uint32_t>&, const Table<uint64_t>&, const Table<uint64_t>&) const;
+	void _preparePendingPrimeData();
+	void _swapInPendingPrimeData();
+	void _allocatePreviousFactors(); // For the current prime table, disabling the delta presieve if it fails
+	void _addCachedAdditionalFactorsToEliminate(Sieve&, uint64_t*, const int);
+	bool _addFactorsToBucket(Sieve&, const uint64_t, const uint16_t*, uint32_t);
+	template <bool, bool> bool _doPresieveRange(const uint64_t, const mpz_class&, const uint64_t, const uint64_t, int*); // Returns false if the presieve must stop
 	void _doPresieveTask(const Task&);
-	void _processSieve(uint64_t*, uint32_t*, const uint64_t, const uint64_t);
-	void _processSieve6(uint64_t*, uint32_t*, uint64_t, const uint64_t);
-	void _processSieve7(uint64_t*, uint32_t*, uint64_t, const uint64_t);
-	void _processSieve7_avx2(uint64_t*, uint32_t*, uint64_t, const uint64_t);
-	void _processSieve8(uint64_t*, uint32_t*, uint64_t, const uint64_t);
-	void _processSieve8_avx2(uint64_t*, uint32_t*, uint64_t, const uint64_t);
+	bool _stealPresieveTask(Task&, const bool);
+	void _processSieve(uint64_t*, uint32_t*, const uint64_t, const uint64_t, const uint32_t);
+	void _processSieve6(uint64_t*, uint32_t*, uint64_t, const uint64_t, const uint32_t);
+	void _processSieve7(uint64_t*, uint32_t*, uint64_t, const uint64_t, const uint32_t);
+	void _processSieve7_avx2(uint64_t*, uint32_t*, uint64_t, const uint64_t, const uint32_t);
+	void _processSieve8(uint64_t*, uint32_t*, uint64_t, const uint64_t, const uint32_t);
+	void _processSieve8_avx2(uint64_t*, uint32_t*, uint64_t, const uint64_t, const uint32_t);
 	void _doSieveTask(Task);
 	bool _testPrimesIspc(const std::array<uint32_t, maxCandidatesPerCheckTask>&, uint32_t[maxCandidatesPerCheckTask], const mpz_class&, mpz_class&);
 	void _doCheckTask(Task);
 	void _doTasks(uint16_t);
 	void _manageTasks();
+	void _runPooledThread(const uint16_t, const bool, uint64_t);
+	void _endThreads();
 	void _suggestLessMemoryIntensiveOptions(const uint64_t, const uint16_t)  const;
 
-	uint64_t _getPrime(uint64_t i) const { 
-		if (i < _nPrimes32) return _primes32[i];
-		else return _primes64[i - _nPrimes32];
-	}
-	uint64_t _getModularInverse(uint64_t i) const {
-		if (i < _nPrimes32) return _modularInverses32[i];
-		else return _modularInverses64[i - _nPrimes32];
-	}
 public:
 	Miner(const Options &options) :
 		_mode(options.mode()), _parameters(MinerParameters()),
 		_client(nullptr),
-		_inited(false), _running(false), _shouldRestart(false), _keepStats(false) {
+		_threadsRun(0), _masterThreadActive(false), _threadsShouldExit(false), _activeWorkerThreads(0),
+		_pendingPrimeDataReady(false), _preloadedDataReady(false),
+		_deltaPresieve(false), _previousAdditionalFactorsOffset(0), _presieveDelta(0), _additionalPresieveDelta(0), _previousFactorsValid(false),
+		_inited(false), _running(false), _shouldRestart(false), _keepStats(false),
+		_activePresieveRanges(0), _presieveCostPerPrime{0., 0., 0.}, _scratchPresieveCostPerPrime{}, _scratchPresieveLimbs(0), _useRemainderTree{false, false, false}, _additionalFactorsArenaFull(false) {
 		_nPrimes = 0;
+		_extendJobs = false;
+		_factorWindows = 1;
+		_factorsBucketBits = factorsBucketBits;
+		_factorsBuckets = 0;
+		_factorsStride = 0;
 		_primesIndexThreshold = 0;
+		_blockSievedPrimesIndex = 0;
+		_primeTableLimit = 0;
 	}
+	~Miner();
 	
 	void setClient(const std::shared_ptr<Client> &client) {_client = client;}
 	bool hasAcceptedPatterns(const std::vector<std::vector<uint64_t>>&) const;
@@ -188,14 +337,20 @@ public:
 		init(minerParameters);
 		startThreads();
 	}
+	void preload(const MinerParameters&);
 	void init(const MinerParameters&);
 	void startThreads();
 	void stop() {
 		if (_running) stopThreads();
 		if (_inited) clear();
 	}
+	void retune(const MinerParameters &minerParameters) { // Like stop() followed by init(), but reusing the data that is still valid
+		if (_running) stopThreads();
+		if (_inited) clear(true);
+		init(minerParameters);
+	}
 	void stopThreads();
-	void clear();
+	void clear(const bool = false); // If true, the data that could be reused is retained for the next initialization
 	bool inited() {return _inited;}
 	bool running() {return _running;}
 	bool shouldRestart() {return _shouldRestart;}
@@ -95,6 +95,14 @@ void Options::parseOptions() {
 			else if (key == "Password") _password = value;
 			else if (key == "PayoutAddress") _payoutAddress = value;
 			else if (key == "EnableAVX2") _minerParameters.useAvx2 = (value == "Yes");
+			else if (key == "EnableAVX512") _minerParameters.useAvx512 = (value == "Yes");
+			else if (key == "ProgressiveStartup") _minerParameters.progressiveStartup = (value == "Yes");
+			else if (key == "CachePrecomputedData") _minerParameters.cachePrecomputedData = (value == "Yes");
+			else if (key == "SharedMemoryTables") _minerParameters.sharedMemoryTables = (value == "Yes");
+			else if (key == "CompactPrimeTable") _minerParameters.compactPrimeTable = (value == "Yes");
+			else if (key == "DeltaPresieve") _minerParameters.deltaPresieve = (value == "Yes");
+			else if (key == "ExtendJobs") _minerParameters.extendJobs = (value == "Yes");
+			else if (key == "InterleavedFactors") _minerParameters.interleavedFactors = (value == "Yes");
 			else if (key == "Secret!!!") _secret = value;
 			else if (key == "Threads") {
 				try {_minerParameters.threads = std::stoi(value);}
@@ -306,15 +314,13 @@ int main(int argc, char** argv) {
 	
 	if (options.filePrimeTableLimit() > 1) {
 		std::cout << "Generating prime table up to " << options.filePrimeTableLimit() << " and saving to " << primeTableFile << "..." << std::endl;
-		std::fstream file(primeTableFile, std::ios::out | std::ios::binary);
-		if (file) {
-			const auto primeTable(generatePrimeTable(options.filePrimeTableLimit()));
-			file.write(reinterpret_cast<const char*>(primeTable.data()), primeTable.size()*sizeof(decltype(primeTable)::value_type));
-			file.close();
-			std::cout << "Table of " << primeTable.size() << " primes generated. Don't forget to disable the generation in " << confPath << std::endl;
-		}
+		std::vector<uint32_t> primes32;
+		std::vector<uint64_t> primes64;
+		generatePrimeTable(options.filePrimeTableLimit(), primes32, primes64, options.minerParameters().threads == 0 ? std::thread::hardware_concurrency() : options.minerParameters().threads);
+		if (writePrimeTableFile(primeTableFile, options.filePrimeTableLimit(), primes32, primes64))
+			std::cout << "Table of " << primes32.size() + primes64.size() << " primes generated. Don't forget to disable the generation in " << confPath << std::endl;
 		else
-			ERRORMSG("Could not open file " << primeTableFile);
+			ERRORMSG("Could not write file " << primeTableFile);
 		return 0;
 	}
 	
@@ -335,6 +341,7 @@ int main(int argc, char** argv) {
 	running = true;
 	if (client->isNetworked()) {
 		const uint32_t waitReconnect(10); // Time in s to wait before auto reconnect.
+		miner->preload(options.minerParameters());
 		while (running) {
 			if (!std::dynamic_pointer_cast<NetworkedClient>(client)->connected()) {
 				std::cout << "Connecting to Riecoin server..." << std::endl;
@@ -372,11 +379,10 @@ int main(int argc, char** argv) {
 				else {
 					if (miner->shouldRestart()) {
 						std::cout << "Restarting miner to take in account Difficulty variations or other network changes." << std::endl;
-						miner->stop();
 						const NetworkInfo networkInfo(std::dynamic_pointer_cast<NetworkedClient>(client)->info());
 						MinerParameters minerParameters(options.minerParameters());
 						minerParameters.pattern = Client::choosePatterns(networkInfo.acceptedPatterns, minerParameters.pattern);
-						miner->init(minerParameters);
+						miner->retune(minerParameters);
 						if (!miner->inited()) {
 							std::cout << "Something went wrong during the miner reinitialization, rieMiner cannot continue." << std::endl;
 							running = false;
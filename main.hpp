@@ -15,8 +15,9 @@
 #include <vector>
 #include "tools.hpp"
 
-#define versionString	"rieMiner 0.92d'"
+#define versionString	"rieMiner 0.92e'"
 #define primeTableFile	"PrimeTable64.bin"
+#define precomputedDataFile	"PrecomputedData.bin"
 
 extern int DEBUG;
 extern std::string confPath;
@@ -66,7 +67,7 @@ static const std::vector<std::pair<std::vector<uint64_t>, std::vector<uint64_t>>
 struct MinerParameters {
 	uint16_t threads, sieveWorkers, tupleLengthMin;
 	uint64_t primorialNumber, primeTableLimit;
-	bool useAvx2;
+	bool useAvx2, useAvx512, progressiveStartup, cachePrecomputedData, sharedMemoryTables, compactPrimeTable, deltaPresieve, extendJobs, interleavedFactors;
 	uint64_t sieveBits, sieveSize, sieveWords, sieveIterations;
 	std::vector<uint64_t> pattern, primorialOffsets;
 	double restartDifficultyFactor;
@@ -74,7 +75,7 @@ struct MinerParameters {
 	MinerParameters() :
 		threads(0), sieveWorkers(0), tupleLengthMin(0),
 		primorialNumber(0), primeTableLimit(0),
-		useAvx2(false),
+		useAvx2(false), useAvx512(true), progressiveStartup(true), cachePrecomputedData(false), sharedMemoryTables(false), compactPrimeTable(false), deltaPresieve(true), extendJobs(true), interleavedFactors(false),
 		sieveBits(0), sieveSize(0), sieveWords(0), sieveIterations(0),
 		pattern{}, primorialOffsets{},
 		restartDifficultyFactor(1.05) {}
@@ -1,6 +1,19 @@
 // (c) 2018-2020 Pttn (https://github.com/Pttn/rieMiner)
 // (c) 2018 Michael Bell/Rockhawk (CPUID tools)
 
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#ifdef _WIN32
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <signal.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
 #include "tools.hpp"
 
 std::random_device randomDevice;
@@ -22,20 +35,589 @@ std::vector<uint8_t> hexStrToV8(std::string str) {
 	return v;
 }
 
-std::vector<uint64_t> generatePrimeTable(const uint64_t limit) {
-	if (limit < 2) return {};
-	std::vector<uint64_t> compositeTable((limit + 127ULL)/128ULL, 0ULL); // Booleans indicating whether an odd number is composite: 0000100100101100...
-	for (uint64_t f(3ULL) ; f*f <= limit ; f += 2ULL) { // Eliminate f and its multiples m for odd f from 3 to square root of the limit
-		if (compositeTable[f >> 7ULL] & (1ULL << ((f >> 1ULL) & 63ULL))) continue; // Skip if f is composite (f and its multiples were already eliminated)
-		for (uint64_t m((f*f) >> 1ULL) ; m <= (limit >> 1ULL) ; m += f) // Start eliminating at f^2 (multiples of f below were already eliminated)
-			compositeTable[m >> 6ULL] |= 1ULL << (m & 63ULL);
+void generatePrimeTable(const uint64_t limit, std::vector<uint32_t> &primes32, std::vector<uint64_t> &primes64, uint16_t threads) {
+	primes32.clear();
+	primes64.clear();
+	if (limit < 2) return;
+	if (threads == 0) threads = 1;
+	constexpr uint64_t segmentWords(4096ULL); // 32 KiB segments (2^18 odd numbers), small enough to stay in the L1 cache while sieving
+	constexpr uint64_t chunkSegments(16ULL); // Segments processed in a row by a thread, the chunk being the unit of work given to the threads
+	constexpr uint64_t segmentBits(64ULL*segmentWords), chunkBits(segmentBits*chunkSegments), chunkWords(segmentWords*chunkSegments);
+	const uint64_t nOdds((limit + 1ULL)/2ULL), // Odd numbers 2i + 1 <= limit for 0 <= i < nOdds
+	               nChunks((nOdds + chunkBits - 1ULL)/chunkBits);
+	// Odd primes up to the square root of the limit, found with a basic sieve, used to sieve the segments.
+	uint64_t sqrtLimit(std::sqrt(static_cast<double>(limit)));
+	while (sqrtLimit*sqrtLimit > limit) sqrtLimit--;
+	while ((sqrtLimit + 1ULL)*(sqrtLimit + 1ULL) <= limit) sqrtLimit++;
+	std::vector<uint64_t> basePrimes;
+	{
+		std::vector<uint8_t> isComposite(sqrtLimit + 1ULL, 0);
+		for (uint64_t f(3ULL) ; f <= sqrtLimit ; f += 2ULL) {
+			if (isComposite[f]) continue;
+			basePrimes.push_back(f);
+			for (uint64_t m(f*f) ; m <= sqrtLimit ; m += 2ULL*f)
+				isComposite[m] = 1;
+		}
+	}
+	// Sieves a chunk segment by segment in the given table of booleans indicating whether an odd number of the chunk is composite (0000100100101100...).
+	// The chunks are sieved twice, to count their primes and then to store them once the tables are allocated, so only a chunk per thread is in memory instead of a table up to the limit.
+	const auto sieveChunk([&](const uint64_t chunk, std::vector<uint64_t> &compositeTable, std::vector<uint64_t> &nextMultiples) {
+		const uint64_t chunkStart(chunk*chunkBits), chunkEnd(std::min(nOdds, chunkStart + chunkBits));
+		std::fill(compositeTable.begin(), compositeTable.end(), 0ULL);
+		if (chunk == 0ULL) compositeTable[0] = 1ULL; // 1 is not prime
+		if ((chunkEnd - chunkStart) % 64ULL != 0ULL) compositeTable[(chunkEnd - chunkStart)/64ULL] |= ~0ULL << ((chunkEnd - chunkStart) % 64ULL); // Numbers beyond the limit
+		for (uint64_t k(0) ; k < basePrimes.size() ; k++) { // Index of the first odd multiple of f >= f^2 in the chunk
+			const uint64_t f(basePrimes[k]), firstMultiple((f*f) >> 1ULL);
+			if (firstMultiple >= chunkStart) nextMultiples[k] = firstMultiple;
+			else {
+				const uint64_t r((chunkStart - firstMultiple) % f);
+				nextMultiples[k] = chunkStart + (r == 0ULL ? 0ULL : f - r);
+			}
+		}
+		for (uint64_t segmentStart(chunkStart) ; segmentStart < chunkEnd ; segmentStart += segmentBits) {
+			const uint64_t segmentEnd(std::min(chunkEnd, segmentStart + segmentBits));
+			for (uint64_t k(0) ; k < basePrimes.size() ; k++) {
+				const uint64_t f(basePrimes[k]);
+				if (((f*f) >> 1ULL) >= segmentEnd) break; // The base primes are sorted, so this is also the case for the next ones
+				uint64_t m(nextMultiples[k]);
+				for ( ; m < segmentEnd ; m += f)
+					compositeTable[(m - chunkStart) >> 6ULL] |= 1ULL << (m & 63ULL);
+				nextMultiples[k] = m;
+			}
+		}
+		return (chunkEnd - chunkStart + 63ULL)/64ULL; // Number of words used
+	});
+	// Each thread takes chunks and counts their primes.
+	std::vector<uint64_t> chunkCounts(nChunks, 0ULL);
+	std::vector<std::thread> sieveThreads;
+	std::atomic<uint64_t> nextChunk(0ULL);
+	for (uint16_t j(0) ; j < threads ; j++) {
+		sieveThreads.push_back(std::thread([&]() {
+			std::vector<uint64_t> compositeTable(chunkWords), nextMultiples(basePrimes.size());
+			for (uint64_t chunk(nextChunk++) ; chunk < nChunks ; chunk = nextChunk++) {
+				const uint64_t nChunkWords(sieveChunk(chunk, compositeTable, nextMultiples));
+				uint64_t count(0ULL);
+				for (uint64_t w(0) ; w < nChunkWords ; w++)
+					count += __builtin_popcountll(~compositeTable[w]);
+				chunkCounts[chunk] = count;
+			}
+		}));
 	}
-	std::vector<uint64_t> primeTable(1, 2);
-	for (uint64_t i(1ULL) ; (i << 1ULL) + 1ULL <= limit ; i++) { // Fill the prime table using the composite table
-		if (!(compositeTable[i >> 6ULL] & (1ULL << (i & 63ULL))))
-			primeTable.push_back((i << 1ULL) + 1ULL); // Add prime number 2i + 1
+	for (auto &sieveThread : sieveThreads) sieveThread.join();
+	sieveThreads.clear();
+	// Allocate the prime tables now that the counts are known, and let the threads sieve the chunks again to fill them.
+	std::vector<uint64_t> chunkFirstIndexes(nChunks, 0ULL);
+	uint64_t nPrimes(1ULL), nPrimes32(1ULL); // Including 2
+	for (uint64_t chunk(0) ; chunk < nChunks ; chunk++) {
+		chunkFirstIndexes[chunk] = nPrimes;
+		nPrimes += chunkCounts[chunk];
+		if (chunk*chunkBits < (1ULL << 31ULL)) // Chunks are aligned with 2^32: odd numbers below it have indexes < 2^31
+			nPrimes32 += chunkCounts[chunk];
+	}
+	primes32.resize(nPrimes32);
+	primes64.resize(nPrimes - nPrimes32);
+	primes32[0] = 2;
+	nextChunk = 0ULL;
+	for (uint16_t j(0) ; j < threads ; j++) {
+		sieveThreads.push_back(std::thread([&]() {
+			std::vector<uint64_t> compositeTable(chunkWords), nextMultiples(basePrimes.size());
+			for (uint64_t chunk(nextChunk++) ; chunk < nChunks ; chunk = nextChunk++) {
+				const uint64_t nChunkWords(sieveChunk(chunk, compositeTable, nextMultiples)), firstWord(chunk*chunkWords);
+				uint64_t primeIndex(chunkFirstIndexes[chunk]);
+				for (uint64_t w(0) ; w < nChunkWords ; w++) {
+					uint64_t primesWord(~compositeTable[w]);
+					while (primesWord != 0ULL) {
+						const uint64_t p(((64ULL*(firstWord + w) + __builtin_ctzll(primesWord)) << 1ULL) + 1ULL); // Add prime number 2i + 1
+						if (primeIndex < nPrimes32) primes32[primeIndex] = p;
+						else primes64[primeIndex - nPrimes32] = p;
+						primeIndex++;
+						primesWord &= primesWord - 1ULL;
+					}
+				}
+			}
+		}));
+	}
+	for (auto &sieveThread : sieveThreads) sieveThread.join();
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &path, const bool sharedMemory) : _data(nullptr), _size(0), _fileHandle(INVALID_HANDLE_VALUE), _mappingHandle(nullptr) {
+	if (sharedMemory) {
+		_mappingHandle = OpenFileMappingA(FILE_MAP_READ, FALSE, ("Local\\" + path).c_str());
+		if (_mappingHandle == nullptr) return;
+		const void *data(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		MEMORY_BASIC_INFORMATION memoryInfo;
+		if (data != nullptr && VirtualQuery(data, &memoryInfo, sizeof(memoryInfo)) != 0) { // The size of a named mapping is not available, but the view spans all of it (rounded up to the page size)
+			_data = reinterpret_cast<const uint8_t*>(data);
+			_size = memoryInfo.RegionSize;
+		}
+		else if (data != nullptr) UnmapViewOfFile(data);
+		return;
+	}
+	_fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (_fileHandle == INVALID_HANDLE_VALUE) return;
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(_fileHandle, &fileSize) || fileSize.QuadPart == 0) return;
+	_mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mappingHandle == nullptr) return;
+	_data = reinterpret_cast<const uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (_data != nullptr) _size = fileSize.QuadPart;
+}
+
+MappedFile::~MappedFile() {
+	if (_data != nullptr) UnmapViewOfFile(_data);
+	if (_mappingHandle != nullptr) CloseHandle(_mappingHandle);
+	if (_fileHandle != INVALID_HANDLE_VALUE) CloseHandle(_fileHandle);
+}
+
+void MappedFile::willNeed(const uint64_t, const uint64_t) const {} // The file was opened for sequential scan, which already enables an aggressive read ahead
+#else
+MappedFile::MappedFile(const std::string &path, const bool sharedMemory) : _data(nullptr), _size(0) {
+	const int fd(sharedMemory ? shm_open(("/" + path).c_str(), O_RDONLY, 0) : open(path.c_str(), O_RDONLY));
+	if (fd < 0) return;
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0) {
+		void *data(mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0));
+		if (data != MAP_FAILED) {
+			_data = reinterpret_cast<const uint8_t*>(data);
+			_size = fileStat.st_size;
+		}
+	}
+	close(fd); // The mapping stays valid after closing the file
+}
+
+MappedFile::~MappedFile() {
+	if (_data != nullptr) munmap(const_cast<uint8_t*>(_data), _size);
+}
+
+void MappedFile::willNeed(const uint64_t offset, const uint64_t length) const {
+	if (_data == nullptr || offset >= _size) return;
+	const uint64_t pageSize(sysconf(_SC_PAGESIZE)), start(offset - offset % pageSize), end(std::min(offset + length, _size));
+	madvise(const_cast<uint8_t*>(_data + start), end - start, MADV_SEQUENTIAL);
+	madvise(const_cast<uint8_t*>(_data + start), end - start, MADV_WILLNEED);
+}
+#endif
+
+void CompactPrimeTable::build(const uint64_t firstIndex, const Table<uint32_t> &primes32, const Table<uint64_t> &primes64, const uint16_t threads) {
+	const uint64_t nPrimes(primes32.size() + primes64.size());
+	const auto prime([&](const uint64_t i) -> uint64_t {return i < primes32.size() ? primes32[i] : primes64[i - primes32.size()];});
+	const auto encodedSize([](const uint64_t gap) -> uint64_t {return gap < 512 ? 1 : 3;});
+	clear();
+	if (firstIndex < 2 || firstIndex >= nPrimes) return; // The gaps from 2 are not even
+	_firstIndex = firstIndex;
+	_size = nPrimes - firstIndex;
+	// The sizes of the parts between checkpoints are computed first so they can then be encoded in parallel
+	_checkpoints.resize((_size + checkpointInterval - 1)/checkpointInterval);
+	parallelFor(_checkpoints.size(), threads, [&](const uint64_t k) {
+		const uint64_t start(firstIndex + k*checkpointInterval), end(std::min(start + checkpointInterval, nPrimes - 1));
+		uint64_t bytes(0);
+		for (uint64_t i(start) ; i < end ; i++)
+			bytes += encodedSize(prime(i + 1) - prime(i));
+		_checkpoints[k] = {prime(start), bytes};
+	});
+	uint64_t position(0);
+	for (auto &checkpoint : _checkpoints) {
+		const uint64_t bytes(checkpoint.position);
+		checkpoint.position = position;
+		position += bytes;
+	}
+	_halfGaps.resize(position + 3*16, 0); // Padding, so decoding a bit beyond the end (for lookahead) stays in the table
+	parallelFor(_checkpoints.size(), threads, [&](const uint64_t k) {
+		const uint64_t start(firstIndex + k*checkpointInterval), end(std::min(start + checkpointInterval, nPrimes - 1));
+		uint8_t *halfGaps(&_halfGaps[_checkpoints[k].position]);
+		for (uint64_t i(start) ; i < end ; i++) {
+			const uint64_t halfGap((prime(i + 1) - prime(i))/2);
+			if (halfGap < 256)
+				*halfGaps++ = halfGap;
+			else {
+				*halfGaps++ = 0;
+				*halfGaps++ = halfGap & 255;
+				*halfGaps++ = halfGap >> 8;
+			}
+		}
+	});
+}
+
+void RemainderTree::build(const std::vector<uint64_t> &primes, const uint64_t leafSize) {
+	_nLeaves = (primes.size() + leafSize - 1)/leafSize;
+	if (_products.size() < 2*_nLeaves - 1) {
+		_products.resize(2*_nLeaves - 1);
+		_remainders.resize(2*_nLeaves - 1);
+	}
+	for (uint64_t k(0) ; k < _nLeaves ; k++) {
+		mpz_class &product(_products[_nLeaves - 1 + k]);
+		product = 1;
+		for (uint64_t j(k*leafSize) ; j < std::min((k + 1)*leafSize, static_cast<uint64_t>(primes.size())) ; j++)
+			mpz_mul_ui(product.get_mpz_t(), product.get_mpz_t(), primes[j]);
+	}
+	for (uint64_t k(_nLeaves - 1) ; k-- > 0 ;)
+		mpz_mul(_products[k].get_mpz_t(), _products[2*k + 1].get_mpz_t(), _products[2*k + 2].get_mpz_t());
+}
+
+void RemainderTree::reduce(const mpz_class &n) {
+	if (_nLeaves == 0) return;
+	mpz_tdiv_r(_remainders[0].get_mpz_t(), n.get_mpz_t(), _products[0].get_mpz_t());
+	for (uint64_t k(1) ; k < 2*_nLeaves - 1 ; k++)
+		mpz_tdiv_r(_remainders[k].get_mpz_t(), _remainders[(k - 1)/2].get_mpz_t(), _products[k].get_mpz_t());
+	for (uint64_t k(_nLeaves - 1) ; k < 2*_nLeaves - 1 ; k++) {
+		if (_remainders[k] == 0) // The product is also divisible by all the primes of the leaf
+			_remainders[k] = _products[k];
+	}
+}
+
+constexpr char sharedTablesMagic[8] = {'R', 'I', 'E', 'S', 'H', 'A', 'R', 'E'};
+constexpr uint32_t sharedTablesVersion(2); // The version 1 segments have no checksums
+
+enum class SharedTablesReservation {Reserved, Exists, Failed};
+#ifdef _WIN32
+static uint64_t currentPid() {return GetCurrentProcessId();}
+
+static bool isProcessRunning(const uint64_t pid) {
+	const HANDLE process(OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid));
+	if (process == nullptr) return false;
+	DWORD exitCode;
+	const bool running(GetExitCodeProcess(process, &exitCode) && exitCode == STILL_ACTIVE);
+	CloseHandle(process);
+	return running;
+}
+
+static bool isOwnedByUser(const std::string&) { // The named file mappings of the Local namespace are only visible in the current session
+	return true;
+}
+
+static SharedTablesReservation reserveSharedTables(const std::string&) { // A named file mapping cannot be resized, so it is only created once the tables are known
+	return SharedTablesReservation::Reserved;
+}
+
+static uint8_t* createSharedTables(const std::string &name, const uint64_t size, void* &mappingHandle) {
+	mappingHandle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, size >> 32, size & 0xFFFFFFFFULL, ("Local\\" + name).c_str());
+	if (mappingHandle == nullptr) return nullptr;
+	if (GetLastError() == ERROR_ALREADY_EXISTS) { // Published by another process in the meantime
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+		return nullptr;
+	}
+	uint8_t *data(reinterpret_cast<uint8_t*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, size)));
+	if (data == nullptr) {
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+	return data;
+}
+
+static void closeSharedTables(uint8_t *data, const uint64_t, void *mappingHandle) {
+	UnmapViewOfFile(data);
+	CloseHandle(mappingHandle); // The named mapping stays as long as another handle to it is open
+}
+
+void removeSharedTables(const std::string&) {}
+#else
+static uint64_t currentPid() {return getpid();}
+
+static bool isProcessRunning(const uint64_t pid) {
+	return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+static bool isOwnedByUser(const std::string &name) { // Else another user could have created it with bogus tables
+	const int fd(shm_open(("/" + name).c_str(), O_RDONLY, 0));
+	if (fd < 0) return true; // Removed in the meantime
+	struct stat segmentStat;
+	const bool owned(fstat(fd, &segmentStat) == 0 && segmentStat.st_uid == geteuid());
+	close(fd);
+	return owned;
+}
+
+static SharedTablesReservation reserveSharedTables(const std::string &name) { // Creates the segment with only the header, so the other processes wait for it instead of computing the tables as well
+	const int fd(shm_open(("/" + name).c_str(), O_RDWR | O_CREAT | O_EXCL, 0600));
+	if (fd < 0) return errno == EEXIST ? SharedTablesReservation::Exists : SharedTablesReservation::Failed;
+	void *data(MAP_FAILED);
+	if (ftruncate(fd, sizeof(SharedTablesHeader)) == 0)
+		data = mmap(nullptr, sizeof(SharedTablesHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		removeSharedTables(name);
+		return SharedTablesReservation::Failed;
+	}
+	SharedTablesHeader &header(*reinterpret_cast<SharedTablesHeader*>(data));
+	header.version = sharedTablesVersion;
+	header.creatorPid = currentPid();
+	__atomic_store_n(&header.ready, 0U, __ATOMIC_RELEASE);
+	std::memcpy(header.magic, sharedTablesMagic, sizeof(sharedTablesMagic)); // The header is considered initialized once the magic is there
+	munmap(data, sizeof(SharedTablesHeader));
+	return SharedTablesReservation::Reserved;
+}
+
+static uint8_t* createSharedTables(const std::string &name, const uint64_t size, void*&) {
+	const int fd(shm_open(("/" + name).c_str(), O_RDWR, 0));
+	if (fd < 0) return nullptr;
+	void *data(MAP_FAILED);
+	if (posix_fallocate(fd, 0, size) == 0) // Unlike Ftruncate, fails if there is not enough space instead of crashing later when writing
+		data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	return data == MAP_FAILED ? nullptr : reinterpret_cast<uint8_t*>(data);
+}
+
+static void closeSharedTables(uint8_t *data, const uint64_t size, void*) {
+	munmap(data, size);
+}
+
+void removeSharedTables(const std::string &name) {
+	shm_unlink(("/" + name).c_str());
+}
+#endif
+
+std::shared_ptr<const MappedFile> attachSharedTables(const std::string &name, bool &reserved, const uint16_t threads) {
+	reserved = false;
+	bool waitMessageShown(false);
+	uint32_t uninitializedChecks(0);
+	while (true) {
+		const std::shared_ptr<const MappedFile> sharedTables(std::make_shared<const MappedFile>(name, true));
+		if (!sharedTables->isValid() || sharedTables->size() < sizeof(SharedTablesHeader)) {
+			if (!sharedTables->isValid()) {
+				const SharedTablesReservation reservation(reserveSharedTables(name));
+				if (reservation == SharedTablesReservation::Reserved) {
+					reserved = true;
+					return nullptr;
+				}
+				else if (reservation == SharedTablesReservation::Failed)
+					return nullptr;
+			}
+			if (!isOwnedByUser(name)) {
+				std::cout << "The shared tables " << name << " belong to another user and are not used" << std::endl;
+				return nullptr;
+			}
+			// Being reserved by another process
+			if (++uninitializedChecks > 100) { // The process likely died while reserving
+				removeSharedTables(name);
+				uninitializedChecks = 0;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			continue;
+		}
+		if (!isOwnedByUser(name)) {
+			std::cout << "The shared tables " << name << " belong to another user and are not used" << std::endl;
+			return nullptr;
+		}
+		const SharedTablesHeader &header(*reinterpret_cast<const SharedTablesHeader*>(sharedTables->data()));
+		if (std::memcmp(header.magic, sharedTablesMagic, sizeof(sharedTablesMagic)) != 0) { // The reserving process writes its Pid before the magic
+			const uint64_t creatorPid(__atomic_load_n(&header.creatorPid, __ATOMIC_ACQUIRE));
+			if (creatorPid != 0 ? !isProcessRunning(creatorPid) : ++uninitializedChecks > 100) {
+				removeSharedTables(name);
+				uninitializedChecks = 0;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			continue;
+		}
+		if (header.version != sharedTablesVersion) {
+			std::cout << "The shared tables " << name << " were published by an incompatible version of rieMiner" << std::endl;
+			return nullptr;
+		}
+		if (__atomic_load_n(&header.ready, __ATOMIC_ACQUIRE) != 0) {
+			if (header.nTables <= sharedTablesMax && header.nTables > 0 && sharedTables->size() >= header.offsets[header.nTables - 1] + header.bytes[header.nTables - 1]) {
+				for (uint64_t i(0) ; i < header.nTables ; i++) {
+					if (parallelChecksum(reinterpret_cast<const uint32_t*>(&sharedTables->data()[header.offsets[i]]), header.bytes[i]/sizeof(uint32_t), threads) != header.checksums[i]) {
+						std::cout << "The shared tables " << name << " are corrupted and were removed" << std::endl;
+						removeSharedTables(name); // Does not affect the processes already using them
+						return nullptr;
+					}
+				}
+				return sharedTables;
+			}
+			else if (header.nTables > sharedTablesMax || header.nTables == 0) {
+				std::cout << "The shared tables " << name << " are invalid" << std::endl;
+				return nullptr;
+			}
+			continue; // Mapped before the segment was resized, map it again
+		}
+		if (!isProcessRunning(header.creatorPid)) { // The publisher died before finishing
+			removeSharedTables(name);
+			continue;
+		}
+		if (!waitMessageShown) {
+			std::cout << "Waiting for the process " << header.creatorPid << " to publish the shared tables " << name << "..." << std::endl;
+			waitMessageShown = true;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+}
+
+std::shared_ptr<const MappedFile> publishSharedTables(const std::string &name, const std::vector<std::pair<const void*, uint64_t>> &tables, const uint16_t threads) {
+	if (tables.size() == 0 || tables.size() > sharedTablesMax) {
+		removeSharedTables(name);
+		return nullptr;
+	}
+	SharedTablesHeader header{};
+	uint64_t size((sizeof(SharedTablesHeader) + 63ULL) & ~63ULL); // The tables are aligned to cache lines
+	for (uint64_t i(0) ; i < tables.size() ; i++) {
+		header.offsets[i] = size;
+		header.bytes[i] = tables[i].second;
+		if (header.bytes[i] % sizeof(uint32_t) != 0) {
+			removeSharedTables(name);
+			return nullptr;
+		}
+		header.checksums[i] = parallelChecksum(reinterpret_cast<const uint32_t*>(tables[i].first), header.bytes[i]/sizeof(uint32_t), threads);
+		size = (size + tables[i].second + 63ULL) & ~63ULL;
+	}
+	void *mappingHandle(nullptr);
+	uint8_t *data(createSharedTables(name, size, mappingHandle));
+	if (data == nullptr) {
+		removeSharedTables(name);
+		return nullptr;
+	}
+	for (uint64_t i(0) ; i < tables.size() ; i++)
+		std::memcpy(&data[header.offsets[i]], tables[i].first, tables[i].second);
+	std::memcpy(header.magic, sharedTablesMagic, sizeof(sharedTablesMagic));
+	header.version = sharedTablesVersion;
+	header.creatorPid = currentPid();
+	header.nTables = tables.size();
+	SharedTablesHeader &sharedHeader(*reinterpret_cast<SharedTablesHeader*>(data));
+	sharedHeader = header;
+	__atomic_store_n(&sharedHeader.ready, 1U, __ATOMIC_RELEASE);
+	const std::shared_ptr<const MappedFile> sharedTables(std::make_shared<const MappedFile>(name, true)); // Opened before closing the writable mapping, which would remove the segment on Windows
+	closeSharedTables(data, size, mappingHandle);
+	if (!sharedTables->isValid()) {
+		removeSharedTables(name);
+		return nullptr;
+	}
+	return sharedTables;
+}
+
+constexpr char primeTableFileMagic[8] = {'R', 'I', 'E', 'P', 'R', 'I', 'M', 'E'};
+constexpr uint32_t primeTableFileVersion(2);
+
+// Offsets of the parts of a version 2 file, and total size
+struct PrimeTableFileLayout {
+	uint64_t nBlocks32, nBlocks64, checksumsOffset, checkpointsOffset, primes32Offset, halfGapsOffset, size;
+	PrimeTableFileLayout(const uint64_t nPrimes32, const uint64_t nPrimes64) :
+		nBlocks32((nPrimes32 + primeTableFileBlockSize - 1)/primeTableFileBlockSize),
+		nBlocks64((nPrimes64 + primeTableFileBlockSize - 1)/primeTableFileBlockSize),
+		checksumsOffset(sizeof(PrimeTableFileHeader)),
+		checkpointsOffset(checksumsOffset + (nBlocks32 + nBlocks64)*sizeof(uint64_t)),
+		primes32Offset(checkpointsOffset + nBlocks64*sizeof(uint64_t)),
+		halfGapsOffset(primes32Offset + nPrimes32*sizeof(uint32_t)),
+		size(halfGapsOffset + nPrimes64*sizeof(uint16_t)) {}
+};
+
+static bool isVersion2File(const MappedFile &mappedFile) {
+	if (mappedFile.size() < sizeof(PrimeTableFileHeader)) return false;
+	const PrimeTableFileHeader &header(*reinterpret_cast<const PrimeTableFileHeader*>(mappedFile.data()));
+	return std::memcmp(header.magic, primeTableFileMagic, sizeof(primeTableFileMagic)) == 0;
+}
+
+PrimeTableFileInfo getPrimeTableFileInfo(const MappedFile &mappedFile) {
+	if (!mappedFile.isValid()) return {0, 0, 0};
+	if (isVersion2File(mappedFile)) {
+		const PrimeTableFileHeader &header(*reinterpret_cast<const PrimeTableFileHeader*>(mappedFile.data()));
+		if (header.version != primeTableFileVersion || header.blockSize != primeTableFileBlockSize || PrimeTableFileLayout(header.nPrimes32, header.nPrimes64).size != mappedFile.size())
+			return {0, 0, 0};
+		return {primeTableFileVersion, header.nPrimes32 + header.nPrimes64, header.limit};
+	}
+	const uint64_t nPrimes(mappedFile.size()/sizeof(uint64_t));
+	if (mappedFile.size() % sizeof(uint64_t) != 0 || nPrimes == 0) return {0, 0, 0};
+	return {1, nPrimes, reinterpret_cast<const uint64_t*>(mappedFile.data())[nPrimes - 1]};
+}
+
+bool writePrimeTableFile(const std::string &path, const uint64_t limit, const std::vector<uint32_t> &primes32, const std::vector<uint64_t> &primes64) {
+	const PrimeTableFileLayout layout(primes32.size(), primes64.size());
+	std::vector<uint64_t> checksums, checkpoints;
+	std::vector<uint16_t> halfGaps(primes64.size());
+	for (uint64_t block(0) ; block < layout.nBlocks32 ; block++) {
+		const uint64_t start(block*primeTableFileBlockSize);
+		checksums.push_back(checksum(&primes32[start], std::min(primeTableFileBlockSize, primes32.size() - start)));
+	}
+	for (uint64_t block(0) ; block < layout.nBlocks64 ; block++) {
+		const uint64_t start(block*primeTableFileBlockSize), end(std::min(start + primeTableFileBlockSize, static_cast<uint64_t>(primes64.size())));
+		checksums.push_back(checksum(&primes64[start], end - start));
+		checkpoints.push_back(primes64[start]);
+		halfGaps[start] = 0;
+		for (uint64_t i(start + 1) ; i < end ; i++) {
+			if (((primes64[i] - primes64[i - 1]) >> 1ULL) > 65535ULL) return false;
+			halfGaps[i] = (primes64[i] - primes64[i - 1]) >> 1ULL;
+		}
+	}
+	PrimeTableFileHeader header{};
+	std::memcpy(header.magic, primeTableFileMagic, sizeof(primeTableFileMagic));
+	header.version = primeTableFileVersion;
+	header.blockSize = primeTableFileBlockSize;
+	header.limit = limit;
+	header.nPrimes32 = primes32.size();
+	header.nPrimes64 = primes64.size();
+	header.checksum = checksum(checksums.data(), checksums.size());
+	std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(checksums.data()), checksums.size()*sizeof(decltype(checksums)::value_type));
+	file.write(reinterpret_cast<const char*>(checkpoints.data()), checkpoints.size()*sizeof(decltype(checkpoints)::value_type));
+	file.write(reinterpret_cast<const char*>(primes32.data()), primes32.size()*sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(halfGaps.data()), halfGaps.size()*sizeof(decltype(halfGaps)::value_type));
+	file.close();
+	return !file.fail();
+}
+
+bool loadPrimeTableFile(const std::shared_ptr<const MappedFile> &mappedFile, const uint64_t limit, Table<uint32_t> &primes32, Table<uint64_t> &primes64, uint16_t threads) {
+	const PrimeTableFileInfo info(getPrimeTableFileInfo(*mappedFile));
+	if (info.version == 1) { // Narrow the primes < 2^32 and view the other ones
+		const uint64_t* const savedPrimes(reinterpret_cast<const uint64_t*>(mappedFile->data()));
+		const uint64_t nPrimes(std::upper_bound(savedPrimes, savedPrimes + info.nPrimes, limit) - savedPrimes),
+		               nPrimes32(std::upper_bound(savedPrimes, savedPrimes + nPrimes, 0xFFFFFFFFULL) - savedPrimes);
+		mappedFile->willNeed(0, nPrimes*sizeof(uint64_t));
+		primes32.resize(nPrimes32);
+		parallelFor((nPrimes32 + primeTableFileBlockSize - 1)/primeTableFileBlockSize, threads, [&](const uint64_t block) {
+			const uint64_t end(std::min((block + 1)*primeTableFileBlockSize, nPrimes32));
+			for (uint64_t i(block*primeTableFileBlockSize) ; i < end ; i++)
+				primes32[i] = savedPrimes[i];
+		});
+		primes64.view(mappedFile, nPrimes32*sizeof(uint64_t), nPrimes - nPrimes32);
+		return true;
+	}
+	else if (info.version != primeTableFileVersion) return false;
+	const PrimeTableFileHeader &header(*reinterpret_cast<const PrimeTableFileHeader*>(mappedFile->data()));
+	const PrimeTableFileLayout layout(header.nPrimes32, header.nPrimes64);
+	const uint64_t* const checksums(reinterpret_cast<const uint64_t*>(mappedFile->data() + layout.checksumsOffset));
+	const uint64_t* const checkpoints(reinterpret_cast<const uint64_t*>(mappedFile->data() + layout.checkpointsOffset));
+	const uint32_t* const savedPrimes32(reinterpret_cast<const uint32_t*>(mappedFile->data() + layout.primes32Offset));
+	const uint16_t* const halfGaps(reinterpret_cast<const uint16_t*>(mappedFile->data() + layout.halfGapsOffset));
+	if (checksum(checksums, layout.nBlocks32 + layout.nBlocks64) != header.checksum) return false;
+	const uint64_t nPrimes32(std::upper_bound(savedPrimes32, savedPrimes32 + header.nPrimes32, std::min(limit, static_cast<uint64_t>(0xFFFFFFFFULL))) - savedPrimes32),
+	               nBlocks32((nPrimes32 + primeTableFileBlockSize - 1)/primeTableFileBlockSize);
+	uint64_t nPrimes64(0), nBlocks64(0);
+	if (limit > 0xFFFFFFFFULL && layout.nBlocks64 > 0 && checkpoints[0] <= limit) { // Find the last needed block and count its primes up to the limit
+		nBlocks64 = std::upper_bound(checkpoints, checkpoints + layout.nBlocks64, limit) - checkpoints;
+		const uint64_t start((nBlocks64 - 1)*primeTableFileBlockSize), end(std::min(start + primeTableFileBlockSize, header.nPrimes64));
+		uint64_t p(checkpoints[nBlocks64 - 1]);
+		nPrimes64 = start + 1;
+		for (uint64_t i(start + 1) ; i < end ; i++) {
+			p += static_cast<uint64_t>(halfGaps[i]) << 1ULL;
+			if (p > limit) break;
+			nPrimes64++;
+		}
+	}
+	mappedFile->willNeed(layout.primes32Offset, nBlocks32*primeTableFileBlockSize*sizeof(uint32_t));
+	mappedFile->willNeed(layout.halfGapsOffset, nBlocks64*primeTableFileBlockSize*sizeof(uint16_t));
+	primes64.resize(nPrimes64);
+	std::atomic<bool> corrupted(false);
+	parallelFor(nBlocks32 + nBlocks64, threads, [&](const uint64_t block) {
+		if (block < nBlocks32) { // The primes < 2^32 are only checked as they are used directly from the mapped file
+			const uint64_t start(block*primeTableFileBlockSize);
+			if (checksum(&savedPrimes32[start], std::min(primeTableFileBlockSize, header.nPrimes32 - start)) != checksums[block])
+				corrupted = true;
+		}
+		else {
+			const uint64_t block64(block - nBlocks32), start(block64*primeTableFileBlockSize), end(std::min(start + primeTableFileBlockSize, header.nPrimes64));
+			std::vector<uint64_t> decodedPrimes(end - start);
+			decodedPrimes[0] = checkpoints[block64];
+			for (uint64_t i(1) ; i < decodedPrimes.size() ; i++)
+				decodedPrimes[i] = decodedPrimes[i - 1] + (static_cast<uint64_t>(halfGaps[start + i]) << 1ULL);
+			if (checksum(decodedPrimes.data(), decodedPrimes.size()) != checksums[layout.nBlocks32 + block64])
+				corrupted = true;
+			std::copy(decodedPrimes.begin(), decodedPrimes.begin() + (std::min(end, nPrimes64) - start), &primes64[start]);
+		}
+	});
+	if (corrupted) {
+		primes64.clear();
+		return false;
 	}
-	return primeTable;
+	primes32.view(mappedFile, layout.primes32Offset, nPrimes32);
+	return true;
 }
 
 constexpr std::array<uint8_t, 128> bech32Values = {
@@ -138,6 +720,7 @@ CpuID::CpuID() {
 		_avx = false;
 		_avx2 = false;
 		_avx512 = false;
+		_avx512ifma = false;
 	}
 	else {
 		__get_cpuid(1, &eax, &ebx, &ecx, &edx);
@@ -152,5 +735,6 @@ CpuID::CpuID() {
 		    : "0"(level), "2"(zero));
 		_avx2 = (ebx & (1 << 5)) != 0;
 		_avx512 = (ebx & (1 << 16)) != 0;
+		_avx512ifma = _avx512 && (ebx & (1 << 17)) != 0 && (ebx & (1 << 21)) != 0;
 	}
 }
@@ -5,7 +5,9 @@
 #define HEADER_tools_hpp
 
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
 #include <condition_variable>
 #include <cstdint>
 #include <cstdio>
@@ -13,10 +15,12 @@
 #include <deque>
 #include <iomanip>
 #include <iostream>
+#include <memory>
 #include <openssl/sha.h>
 #include <random>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <cpuid.h>
 #include <gmpxx.h>
@@ -40,6 +44,16 @@ inline std::array<uint8_t, 32> v8ToA8(std::vector<uint8_t> v8) {
 inline std::vector<uint8_t> a8ToV8(const std::array<uint8_t, 32> &a8) {
 	return std::vector<uint8_t>(a8.begin(), a8.end());
 }
+inline mpz_class u64ToMpz(const uint64_t u64) {
+	mpz_class mpz;
+	mpz_import(mpz.get_mpz_t(), 1, 1, 8, 0, 0, &u64);
+	return mpz;
+}
+inline uint64_t mpzToU64(const mpz_class &mpz) { // The number must be non negative and fit in 64 bits
+	uint64_t u64(0);
+	mpz_export(&u64, nullptr, -1, 8, 0, 0, mpz.get_mpz_t());
+	return u64;
+}
 
 template <class C> inline C reverse(C c) {
 	std::reverse(c.begin(), c.end());
@@ -66,7 +80,243 @@ inline std::array<uint8_t, 32> sha256sha256(const uint8_t *data, uint32_t len) {
 	return sha256(sha256(data, len).data(), 32);
 }
 
-std::vector<uint64_t> generatePrimeTable(const uint64_t);
+// Runs the function for every index from 0 to n - 1 using the given number of threads, which take the next index once they are done with the current one.
+template <class F> void parallelFor(const uint64_t n, const uint16_t threads, const F &f) {
+	std::atomic<uint64_t> next(0ULL);
+	std::vector<std::thread> forThreads;
+	for (uint16_t j(0) ; j < std::max(threads, static_cast<uint16_t>(1)) ; j++) {
+		forThreads.push_back(std::thread([&]() {
+			for (uint64_t i(next++) ; i < n ; i = next++)
+				f(i);
+		}));
+	}
+	for (auto &forThread : forThreads) forThread.join();
+}
+
+template <class T> uint64_t checksum(const T *numbers, const uint64_t n) { // FNV-1a on the numbers
+	uint64_t checksum(14695981039346656037ULL);
+	for (uint64_t i(0) ; i < n ; i++) {
+		checksum ^= numbers[i];
+		checksum *= 1099511628211ULL;
+	}
+	return checksum;
+}
+template <class T> uint64_t parallelChecksum(const T *numbers, const uint64_t n, const uint16_t threads) { // Checksum of the checksums of blocks of 2^20 numbers
+	constexpr uint64_t blockSize(1048576ULL);
+	std::vector<uint64_t> checksums((n + blockSize - 1ULL)/blockSize);
+	parallelFor(checksums.size(), threads, [&](const uint64_t block) {
+		checksums[block] = checksum(&numbers[block*blockSize], std::min(blockSize, n - block*blockSize));
+	});
+	return checksum(checksums.data(), checksums.size());
+}
+
+// Inverse of a modulo m, a and m being coprime and m < 2^63, using the extended Euclidean algorithm on machine words.
+// It is much faster than Mpz_Invert, and the 32 bits version even more as the divisions are cheaper.
+template <class T> T invert(T a, const T m) {
+	int64_t t(0), newT(1);
+	T r(m);
+	while (a != 0) {
+		const T q(r/a), newR(r - q*a);
+		const int64_t tmp(t - static_cast<int64_t>(q)*newT);
+		t = newT;
+		newT = tmp;
+		r = a;
+		a = newR;
+	}
+	return t < 0 ? static_cast<T>(t + static_cast<int64_t>(m)) : static_cast<T>(t);
+}
+
+// Generates the prime numbers up to the limit using a segmented Sieve of Eratosthenes and the given number of threads, which only need a chunk of 512 kB each besides the tables.
+// The primes below 2^32 are stored in the first vector and the larger ones in the second.
+void generatePrimeTable(const uint64_t, std::vector<uint32_t>&, std::vector<uint64_t>&, uint16_t = 1);
+
+// Read only memory mapping of a whole file, or of a named shared memory object. The pages come from the page cache and are shared with the other processes mapping the same file.
+class MappedFile {
+	const uint8_t *_data;
+	uint64_t _size;
+#ifdef _WIN32
+	void *_fileHandle, *_mappingHandle;
+#endif
+public:
+	MappedFile(const std::string&, const bool = false); // Path, or name of a shared memory object if the second argument is true
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	bool isValid() const {return _data != nullptr;}
+	const uint8_t* data() const {return _data;}
+	uint64_t size() const {return _size;}
+	void willNeed(const uint64_t, const uint64_t) const; // Hints the system to read ahead the given range (offset, length) as it will be accessed sequentially soon
+};
+
+// Table of numbers which either owns its elements, or is a read only view of a part of a mapped file (avoiding a copy), accessed in the same way.
+template <class T> class Table {
+	std::vector<T> _owned;
+	std::shared_ptr<const MappedFile> _mappedFile; // Keeps the mapping alive while it is viewed
+	T *_data;
+	uint64_t _size;
+public:
+	Table() : _data(nullptr), _size(0) {}
+	Table(const Table&) = delete;
+	Table& operator=(const Table&) = delete;
+	void resize(const uint64_t size) {
+		_mappedFile.reset();
+		_owned.resize(size);
+		_data = _owned.data();
+		_size = size;
+	}
+	void assign(std::vector<T> &&v) {
+		_mappedFile.reset();
+		_owned = std::move(v);
+		_data = _owned.data();
+		_size = _owned.size();
+	}
+	void view(const std::shared_ptr<const MappedFile> &mappedFile, const uint64_t offset, const uint64_t size) {
+		_owned = std::vector<T>();
+		_mappedFile = mappedFile;
+		_data = const_cast<T*>(reinterpret_cast<const T*>(mappedFile->data() + offset));
+		_size = size;
+	}
+	void swap(Table &other) {
+		_owned.swap(other._owned); // The addresses of the elements do not change
+		_mappedFile.swap(other._mappedFile);
+		std::swap(_data, other._data);
+		std::swap(_size, other._size);
+	}
+	void truncate(const uint64_t size) {_size = std::min(size, _size);}
+	void shrink(const uint64_t size) { // Truncates, also freeing the memory of the removed elements if they are owned
+		truncate(size);
+		if (!isView() && _owned.size() > _size) {
+			std::vector<T> owned(_owned.begin(), _owned.begin() + _size);
+			_owned.swap(owned);
+			_data = _owned.data();
+		}
+	}
+	void clear() {
+		_owned = std::vector<T>(); // Also frees the memory
+		_mappedFile.reset();
+		_data = nullptr;
+		_size = 0;
+	}
+	T& operator[](const uint64_t i) {return _data[i];}
+	const T& operator[](const uint64_t i) const {return _data[i];}
+	T* data() {return _data;}
+	const T* data() const {return _data;}
+	uint64_t size() const {return _size;}
+	bool empty() const {return _size == 0;}
+	bool isView() const {return _mappedFile != nullptr;}
+	uint64_t bytes() const {return _size*sizeof(T);}
+};
+
+// Prime table file, version 2: a header, a checksum for every block of primes, the first prime of every block >= 2^32, then the primes < 2^32 as raw 32 bits numbers (usable directly from the mapped file),
+// and the primes >= 2^32 as 16 bits half gaps from the previous prime of their block (2 bytes instead of 8 per prime, the gaps being smaller than 1600 for numbers below 2^64).
+// The blocks can be checked and decoded in parallel. The version 1 files, made of raw 64 bits numbers, are still supported.
+constexpr uint64_t primeTableFileBlockSize(65536); // Number of primes in a block
+struct PrimeTableFileHeader {
+	char magic[8]; // "RIEPRIME"
+	uint32_t version, blockSize;
+	uint64_t limit; // The file contains all the primes up to this number
+	uint64_t nPrimes32, nPrimes64;
+	uint64_t checksum; // Of the blocks' checksums
+	uint64_t reserved[2];
+};
+struct PrimeTableFileInfo {
+	uint32_t version; // 0 for an invalid file
+	uint64_t nPrimes, limit;
+};
+PrimeTableFileInfo getPrimeTableFileInfo(const MappedFile&);
+bool writePrimeTableFile(const std::string&, const uint64_t, const std::vector<uint32_t>&, const std::vector<uint64_t>&);
+// Loads the primes up to the limit into the tables, viewing the mapped file when possible, using the given number of threads. Returns false if the file is corrupted.
+bool loadPrimeTableFile(const std::shared_ptr<const MappedFile>&, const uint64_t, Table<uint32_t>&, Table<uint64_t>&, uint16_t = 1);
+
+// Compact table of consecutive primes from a given index of a prime table, stored as half gaps from the previous prime in a byte, or a 0 byte followed by a 16 bits half gap for the rare gaps >= 512.
+// This takes a bit more than 1 byte per prime instead of 4 or 8. The primes are decoded sequentially from a checkpoint, which is made every checkpointInterval primes.
+class CompactPrimeTable {
+	struct Checkpoint {
+		uint64_t prime, position; // The prime, and position of the half gap to the next one
+	};
+	uint64_t _firstIndex, _size;
+	std::vector<Checkpoint> _checkpoints;
+	std::vector<uint8_t> _halfGaps;
+public:
+	static constexpr uint64_t checkpointInterval = 1024;
+	class Decoder {
+		const uint8_t *_halfGaps;
+		uint64_t _prime;
+	public:
+		Decoder() : _halfGaps(nullptr), _prime(0) {}
+		Decoder(const uint8_t *halfGaps, const uint64_t prime) : _halfGaps(halfGaps), _prime(prime) {}
+		uint64_t prime() const {return _prime;}
+		uint64_t next() { // Decodes and returns the next prime
+			uint64_t halfGap(*_halfGaps++);
+			if (halfGap == 0) {
+				halfGap = static_cast<uint64_t>(_halfGaps[0]) | (static_cast<uint64_t>(_halfGaps[1]) << 8);
+				_halfGaps += 2;
+			}
+			_prime += 2*halfGap;
+			return _prime;
+		}
+	};
+	CompactPrimeTable() : _firstIndex(0), _size(0) {}
+	// Encodes the primes from the given index of the table (made of the two parts as usual) using the given number of threads
+	void build(const uint64_t, const Table<uint32_t>&, const Table<uint64_t>&, const uint16_t = 1);
+	Decoder decoder(const uint64_t i) const { // Decoder positioned at the prime of index i in the original table (i >= firstIndex)
+		const Checkpoint &checkpoint(_checkpoints[(i - _firstIndex)/checkpointInterval]);
+		Decoder decoder(&_halfGaps[checkpoint.position], checkpoint.prime);
+		for (uint64_t j(0) ; j < (i - _firstIndex) % checkpointInterval ; j++) decoder.next();
+		return decoder;
+	}
+	uint64_t operator[](const uint64_t i) const {return decoder(i).prime();}
+	void swap(CompactPrimeTable &other) {
+		std::swap(_firstIndex, other._firstIndex);
+		std::swap(_size, other._size);
+		_checkpoints.swap(other._checkpoints);
+		_halfGaps.swap(other._halfGaps);
+	}
+	void clear() {
+		_firstIndex = 0;
+		_size = 0;
+		_checkpoints = std::vector<Checkpoint>();
+		_halfGaps = std::vector<uint8_t>();
+	}
+	uint64_t firstIndex() const {return _firstIndex;}
+	uint64_t size() const {return _size;}
+	bool empty() const {return _size == 0;}
+	uint64_t bytes() const {return _checkpoints.size()*sizeof(Checkpoint) + _halfGaps.size();}
+};
+
+// Product tree of blocks of primes (the leaves), used to reduce a large number modulo the products of the blocks, and then each block product modulo the ones below it.
+// The remainders modulo the primes of a leaf can then be computed from a number of the size of the leaf product instead of the original one. The numbers are reused between builds to not reallocate them, so a tree should be kept as long as possible.
+class RemainderTree {
+	uint64_t _nLeaves;
+	std::vector<mpz_class> _products, _remainders; // Node k has the children 2k + 1 and 2k + 2, the leaves being the last _nLeaves nodes
+public:
+	RemainderTree() : _nLeaves(0) {}
+	void build(const std::vector<uint64_t>&, const uint64_t); // From the primes and the number of primes per leaf
+	void reduce(const mpz_class&);
+	uint64_t nLeaves() const {return _nLeaves;}
+	const mpz_class& remainder(const uint64_t k) const {return _remainders[_nLeaves - 1 + k];} // Never 0, so it can be given to the assembly functions
+};
+
+// Named shared memory segment holding immutable tables, published once by a process and attached read only by the others, to not have a copy per process.
+// It is a POSIX shared memory object, which stays until removed or reboot, or a named file mapping on Windows, which disappears when no process uses it anymore.
+constexpr uint64_t sharedTablesMax(8);
+struct SharedTablesHeader {
+	char magic[8]; // "RIESHARE"
+	uint32_t version, ready; // Ready is set once all the tables are written
+	uint64_t creatorPid; // Process publishing the tables, used to detect if it died before finishing
+	uint64_t nTables, offsets[sharedTablesMax], bytes[sharedTablesMax];
+	uint64_t checksums[sharedTablesMax]; // Parallel checksums of the tables as 32 bits numbers
+};
+// Attaches to the named segment, waiting if another process is publishing it, and verifies the checksums of its tables using the given number of threads. Returns nullptr if it does not exist,
+// reserving it if possible: in this case the reserved argument is set to true, and the caller must publish the tables or remove the segment. A segment belonging to another user is never used.
+std::shared_ptr<const MappedFile> attachSharedTables(const std::string&, bool&, const uint16_t);
+// Copies the tables (address, size in bytes, multiple of 4) to the named segment and returns its read only mapping, or nullptr if it failed (the segment is then removed).
+std::shared_ptr<const MappedFile> publishSharedTables(const std::string&, const std::vector<std::pair<const void*, uint64_t>>&, const uint16_t);
+void removeSharedTables(const std::string&);
+template <class T> void viewSharedTable(const std::shared_ptr<const MappedFile> &sharedTables, const uint64_t index, Table<T> &table) {
+	const SharedTablesHeader &header(*reinterpret_cast<const SharedTablesHeader*>(sharedTables->data()));
+	table.view(sharedTables, header.offsets[index], header.bytes[index]/sizeof(T));
+}
 
 // Bech32 Code adapted from the reference C++ implementation, https://github.com/sipa/bech32/tree/master/ref/c%2B%2B
 std::vector<uint8_t> bech32ToScriptPubKey(const std::string&);
@@ -79,13 +329,14 @@ inline double timeSince(const std::chrono::time_point<std::chrono::steady_clock>
 
 class CpuID {
 	std::string _brand;
-	bool _avx, _avx2, _avx512;
+	bool _avx, _avx2, _avx512, _avx512ifma; // The latter also implies AVX-512 DQ
 public:
 	CpuID();
 	std::string getBrand() const {return _brand;}
 	bool hasAVX() const {return _avx;}
 	bool hasAVX2() const {return _avx2;}
 	bool hasAVX512() const {return _avx512;}
+	bool hasAVX512IFMA() const {return _avx512ifma;}
 };
 
 template<class T> class TsQueue {